@@ -0,0 +1,32 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdint>
+
+// The benchmarks are plain executables that print their numbers. They are
+// meant for comparing builds on the same machine, not for absolute figures.
+
+namespace bench {
+
+// keeps the compiler from dropping the work whose result is thrown away
+inline volatile uint64_t sink = 0;
+
+// the time a call of `fn` takes on average, in nanoseconds
+template <typename Fn> double time_per_call(std::size_t num_calls, Fn fn) {
+    // one call to warm up caches and buffers
+    fn();
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < num_calls; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(num_calls);
+}
+
+} // namespace bench
+
+#endif // BENCH_H
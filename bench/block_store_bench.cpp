@@ -0,0 +1,83 @@
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "bench.hpp"
+#include "macros.hpp"
+#include "sampling/block_store.hpp"
+
+using bandwit::sampling::BlockCodec;
+using bandwit::sampling::BlockStore;
+
+// the block size of TimeSeries
+static const std::size_t block_size = 64;
+static const std::size_t num_blocks = 1024;
+static const std::size_t num_points = block_size * num_blocks;
+
+static void run(const char *name, const std::function<uint64_t()> &next) {
+    std::vector<uint64_t> values(num_points);
+    for (auto &value : values) {
+        value = next();
+    }
+
+    BlockStore store{block_size, num_blocks};
+    BlockCodec codec{};
+    std::vector<uint8_t> encoded{};
+    std::size_t num_encoded = 0;
+
+    uint64_t base = 0;
+    for (std::size_t block = 0; block < num_blocks; ++block) {
+        const auto *block_values = values.data() + block * block_size;
+        store.seal(block, block_values, base);
+
+        codec.encode(block_values, block_size, encoded);
+        num_encoded += encoded.size();
+
+        for (std::size_t i = 0; i < block_size; ++i) {
+            base += block_values[i];
+        }
+    }
+
+    std::vector<uint64_t> decoded(block_size);
+    std::size_t block = 0;
+    auto per_block = bench::time_per_call(num_blocks * 50, [&]() {
+        store.decode(block, decoded.data());
+        bench::sink = bench::sink + decoded[block_size - 1];
+        block = (block + 1) % num_blocks;
+    });
+
+    printf("%-8s %10.2f %14.2f %16.0f\n", name,
+           F64(num_encoded) / F64(num_points),
+           F64(store.memory_usage()) / F64(num_points),
+           F64(block_size) / per_block * 1000.0);
+}
+
+int main() {
+    std::mt19937_64 rng{42};
+
+    printf("%zu points in blocks of %zu, bytes per point encoded and with the "
+           "block overhead\n\n",
+           num_points, block_size);
+    printf("%-8s %10s %14s %16s\n", "traffic", "encoded", "in memory",
+           "decoded Mpts/s");
+
+    // an unused link: no traffic at all
+    run("idle", []() { return uint64_t{0}; });
+
+    // a quiet link, the odd packet every few seconds
+    std::bernoulli_distribution some_packets{0.2};
+    std::uniform_int_distribution<uint64_t> packet{60, 1500};
+    run("quiet", [&]() { return some_packets(rng) ? packet(rng) : 0; });
+
+    // a saturated gigabit link, within a percent of line rate
+    std::normal_distribution<double> steady{125000000.0, 1250000.0};
+    run("steady", [&]() { return U64(std::llround(steady(rng))); });
+
+    // a desktop, mostly a low rate with a long tail
+    std::lognormal_distribution<double> bursty{10.0, 2.0};
+    run("bursty", [&]() { return U64(std::llround(bursty(rng))); });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "sampling/procfs_sampler.hpp"
+
+using bandwit::sampling::ProcFsParser;
+
+// Writes a /proc/net/dev with `num_ifaces` interfaces, veth00000 and on.
+static std::vector<std::string> write_netdev(const std::string &filepath,
+                                             std::size_t num_ifaces) {
+    FILE *fl = fopen(filepath.c_str(), "w");
+    if (fl == nullptr) {
+        perror("fopen");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(fl, "Inter-|   Receive                                          "
+                "      |  Transmit\n"
+                " face |bytes    packets errs drop fifo frame compressed "
+                "multicast|bytes    packets errs drop fifo colls carrier "
+                "compressed\n");
+
+    std::mt19937_64 rng{42};
+    std::uniform_int_distribution<uint64_t> counter{0, uint64_t{1} << 40};
+
+    std::vector<std::string> names{};
+    for (std::size_t i = 0; i < num_ifaces; ++i) {
+        char name[16];
+        snprintf(name, sizeof(name), "veth%05zu", i);
+        names.emplace_back(name);
+
+        fprintf(fl, "%s:", name);
+        for (int field = 0; field < 16; ++field) {
+            fprintf(fl, " %lu", counter(rng));
+        }
+        fprintf(fl, "\n");
+    }
+
+    fclose(fl);
+    return names;
+}
+
+int main(int argc, char **argv) {
+    std::string filepath = argc > 1 ? argv[1] : "/tmp/bw_bench_netdev";
+    const std::size_t num_ifaces = 10000;
+
+    auto names = write_netdev(filepath, num_ifaces);
+    ProcFsParser parser{filepath};
+
+    printf("synthetic /proc/net/dev with %zu interfaces\n", num_ifaces);
+
+    // the last interface in the file, the worst case for a single lookup
+    const auto &last = names.back();
+    auto one = bench::time_per_call(200, [&]() {
+        auto contents = parser.read_file();
+        bench::sink = bench::sink + parser.parse(contents, last).first;
+    });
+    printf("  read + parse of 1 interface:      %10.1f us\n", one / 1000.0);
+
+    // the parsing alone, without reading the file
+    auto contents = parser.read_file();
+    auto parse_one = bench::time_per_call(200, [&]() {
+        bench::sink = bench::sink + parser.parse(contents, last).first;
+    });
+    printf("  parse of 1 interface:             %10.1f us\n",
+           parse_one / 1000.0);
+
+    // what sampling every interface one at a time costs
+    // (ProcFsSampler::get_sample), against a single pass (get_samples)
+    for (std::size_t num_sampled : {std::size_t{10}, std::size_t{100}}) {
+        std::vector<std::string> sampled(names.end() - num_sampled,
+                                         names.end());
+
+        auto per_iface = bench::time_per_call(20, [&]() {
+            for (const auto &name : sampled) {
+                auto contents = parser.read_file();
+                bench::sink = bench::sink + parser.parse(contents, name).first;
+            }
+        });
+
+        std::vector<std::pair<uint64_t, uint64_t>> counters{};
+        auto batch = bench::time_per_call(200, [&]() {
+            auto contents = parser.read_file();
+            parser.parse_all(contents, sampled, counters);
+            bench::sink = bench::sink + counters.back().first;
+        });
+
+        printf("  %3zu interfaces, one by one:       %10.1f us\n",
+               num_sampled, per_iface / 1000.0);
+        printf("  %3zu interfaces, in a single pass: %10.1f us\n",
+               num_sampled, batch / 1000.0);
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> counters{};
+    auto all = bench::time_per_call(200, [&]() {
+        auto contents = parser.read_file();
+        parser.parse_all(contents, names, counters);
+        bench::sink = bench::sink + counters.back().first;
+    });
+    printf("  read + parse of all interfaces:   %10.1f us\n", all / 1000.0);
+
+    contents = parser.read_file();
+    auto parse_all = bench::time_per_call(200, [&]() {
+        parser.parse_all(contents, names, counters);
+        bench::sink = bench::sink + counters.back().first;
+    });
+    printf("  parse of all interfaces:          %10.1f us\n",
+           parse_all / 1000.0);
+
+    remove(filepath.c_str());
+    return EXIT_SUCCESS;
+}
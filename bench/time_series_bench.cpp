@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "bench.hpp"
+#include "sampling/interface_series_store.hpp"
+
+using bandwit::Millis;
+using bandwit::TimePoint;
+using namespace bandwit::sampling;
+
+int main() {
+    TimePoint start{std::chrono::seconds(1700000000)};
+    const Millis interval{100};
+
+    std::vector<Retention> retentions{};
+    for (auto window : get_windows(interval)) {
+        retentions.push_back(Retention{window, 4096, 4096});
+    }
+    retentions.front().sketch_slots = 0;
+
+    InterfaceSeriesStore store{start, retentions};
+
+    // a sample every interval, a little late now and then, through days of
+    // history so every level has rolled up
+    std::size_t num_samples = 0;
+    auto inc = bench::time_per_call(10000000, [&]() {
+        auto tp = start + interval * num_samples +
+                  std::chrono::microseconds(num_samples % 997);
+        store.inc(tp, MetricValues{num_samples % 5000, num_samples % 700});
+        ++num_samples;
+    });
+    printf("store inc:                 %8.1f ns\n", inc);
+
+    TimeSeries series{Millis{1000}, start, 1U << 20, 2};
+    std::size_t num_keys = 0;
+    auto calculate_key = bench::time_per_call(20000000, [&]() {
+        auto tp = start + std::chrono::microseconds(num_keys * 50001);
+        bench::sink = bench::sink + series.calculate_key(tp);
+        ++num_keys;
+    });
+    printf("calculate_key:             %8.2f ns\n", calculate_key);
+
+    TimeSeriesSlice slice{};
+    for (auto stat : {Statistic::AVERAGE, Statistic::P95}) {
+        for (auto window : {AggregationWindow::ONE_SECOND,
+                            AggregationWindow::ONE_MINUTE}) {
+            auto per_slice = bench::time_per_call(2000, [&]() {
+                store.get_slice_from_point(Metric::RX_BYTES, window,
+                                           store.max(window), 200, stat,
+                                           slice);
+            });
+            printf("200 column %-7s %-6s %8.2f us\n",
+                   get_label(stat).c_str(), get_label(window).c_str(),
+                   per_slice / 1000.0);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
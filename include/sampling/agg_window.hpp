@@ -1,22 +1,48 @@
 #ifndef AGG_WINDOW_H
 #define AGG_WINDOW_H
 
+#include <optional>
 #include <string>
+#include <vector>
+
+#include "aliases.hpp"
 
 namespace bandwit {
 namespace sampling {
 
+// The value is the length of the window in milliseconds. The enumerators are
+// the windows a time series is kept for, but any length that is a multiple of
+// one of them can be shown, eg. 5 seconds or 15 minutes.
 enum class AggregationWindow {
-    ONE_SECOND = 1,
-    ONE_MINUTE = 60,
-    ONE_HOUR = 3600,
-    ONE_DAY = 86400,
+    HUNDRED_MILLIS = 100,
+    QUARTER_SECOND = 250,
+    HALF_SECOND = 500,
+    ONE_SECOND = 1000,
+    ONE_MINUTE = 60000,
+    ONE_HOUR = 3600000,
+    ONE_DAY = 86400000,
 };
 
+// the number of enumerators, which are the windows a time series can be kept
+// for
+constexpr std::size_t num_windows = 7;
+
 AggregationWindow next_interval(AggregationWindow agg_window);
 AggregationWindow prev_interval(AggregationWindow agg_window);
 std::string get_label(AggregationWindow agg_window);
 
+Millis get_interval(AggregationWindow agg_window);
+std::optional<AggregationWindow> window_from_interval(Millis interval);
+// like window_from_interval, but also for lengths that are not an enumerator
+AggregationWindow window_from_length(Millis length);
+
+// The position of an enumerator among them, finest first. Lengths that are not
+// an enumerator have no position.
+std::optional<std::size_t> get_window_index(AggregationWindow agg_window);
+
+// The windows that are a whole number of sampling intervals, finest first
+std::vector<AggregationWindow> get_windows(Millis sampling_interval);
+
 } // namespace sampling
 } // namespace bandwit
 
@@ -0,0 +1,28 @@
+#ifndef METRIC_H
+#define METRIC_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace bandwit {
+namespace sampling {
+
+// The counters we keep a history of for an interface. The value is the
+// column of the counter in the time series.
+enum class Metric {
+    RX_BYTES,
+    TX_BYTES,
+};
+
+constexpr std::size_t num_metrics = 2;
+
+// a value for every metric, indexed by the metric
+using MetricValues = std::array<uint64_t, num_metrics>;
+
+std::string get_label(Metric metric);
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // METRIC_H
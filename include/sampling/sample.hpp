@@ -2,7 +2,8 @@
 #define SAMPLE_H
 
 #include <cstdint>
-#include <ctime>
+
+#include "aliases.hpp"
 
 namespace bandwit {
 namespace sampling {
@@ -11,7 +12,8 @@ struct Sample {
     uint64_t rx;
     uint64_t tx;
 
-    std::time_t ts;
+    // when the counters were read, with sub-second resolution
+    TimePoint ts;
 };
 
 } // namespace sampling
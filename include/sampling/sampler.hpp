@@ -2,6 +2,7 @@
 #define SAMPLER_H
 
 #include <string>
+#include <vector>
 
 #include "macros.hpp"
 #include "sample.hpp"
@@ -22,7 +23,14 @@ class Sampler {
     CLASS_DISABLE_COPIES(Sampler)
     CLASS_DISABLE_MOVES(Sampler)
 
-    virtual Sample get_sample(const std::string &iface_name) const = 0;
+    // samplers may keep state (open files, sockets) between calls
+    virtual Sample get_sample(const std::string &iface_name) = 0;
+
+    // Samples many interfaces in one go, filling `samples` in the same order
+    // as the names. Samplers that can read every interface from a single
+    // source override this, the default just calls get_sample for each one.
+    virtual void get_samples(const std::vector<std::string> &iface_names,
+                             std::vector<Sample> &samples);
 };
 
 } // namespace sampling
@@ -6,13 +6,24 @@
 namespace bandwit {
 namespace sampling {
 
+// MAX, MIN and the percentiles are taken over the samples in a bucket, and
+// shown per second like the average.
 enum class Statistic {
     AVERAGE,
     SUM,
+    MAX,
+    MIN,
+    P95,
+    P99,
 };
 
+Statistic next_statistic(Statistic stat);
 std::string get_label(Statistic stat);
 
+// whether the statistic comes from the distribution of the samples rather than
+// their sum
+bool is_distribution(Statistic stat);
+
 } // namespace sampling
 } // namespace bandwit
 
@@ -10,26 +10,27 @@
 namespace bandwit {
 namespace sampling {
 
-// FIXME: should this be a struct?
+// Consecutive buckets of a time series, the first of which starts at `start`.
+// Only the values are stored, the time point of a bucket follows from its
+// position.
+//
+// A slice is meant to be filled again for every frame, which reuses the
+// buffer of the values, so that drawing doesn't allocate once the width of
+// the chart has settled.
 class TimeSeriesSlice {
   public:
-    explicit TimeSeriesSlice(std::vector<TimePoint> tps,
-                             std::vector<uint64_t> vals,
-                             AggregationWindow agg_win)
-        : time_points{std::move(tps)}, values{std::move(vals)}, agg_window{
-                                                                    agg_win} {}
-
-    // We need this to be able to declare a variable in an outer scope and
-    // populate it in an inner scope. The value should not be used for anything
-    // cause it's going to be empty.
-    TimeSeriesSlice() {}
-
-    std::vector<TimePoint> time_points{};
+    std::size_t size() const { return values.size(); }
+
+    TimePoint time_point(std::size_t i) const {
+        return start + get_interval(agg_window) * i;
+    }
+
     std::vector<uint64_t> values{};
-    AggregationWindow agg_window;
+    TimePoint start{};
+    AggregationWindow agg_window{AggregationWindow::ONE_SECOND};
 };
 
 } // namespace sampling
 } // namespace bandwit
 
-#endif // TIME_SERIES_SLICE_H
\ No newline at end of file
+#endif // TIME_SERIES_SLICE_H
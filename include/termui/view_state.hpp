@@ -0,0 +1,41 @@
+#ifndef VIEW_STATE_H
+#define VIEW_STATE_H
+
+#include <cstdint>
+
+namespace bandwit {
+namespace termui {
+
+// The things a frame is drawn from
+enum class ViewChange : uint8_t {
+    // the samples in the visible part of the series, or the sampling stats
+    // shown along with them
+    DATA = 1U << 0U,
+    // the scroll cursor or the aggregation window
+    CURSOR = 1U << 1U,
+    SCALE = 1U << 2U,
+    STATISTIC = 1U << 3U,
+    // the size of the window, or where the surface is on it
+    WINDOW_SIZE = 1U << 4U,
+    // rx or tx, and whether the instrumentation is shown
+    MODE = 1U << 5U,
+};
+
+// Which of the things a frame is drawn from changed since the last frame, so
+// that there's only a new frame when something visible changed.
+class ViewState {
+  public:
+    void mark_dirty(ViewChange change);
+    bool is_dirty() const;
+
+    // after a frame has been drawn
+    void mark_clean();
+
+  private:
+    uint8_t dirty_{0};
+};
+
+} // namespace termui
+} // namespace bandwit
+
+#endif // VIEW_STATE_H
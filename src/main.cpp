@@ -2,16 +2,26 @@
 #include <iostream>
 #include <unistd.h>
 
+#include "options.hpp"
+#include "sampling/retention.hpp"
 #include "termui/signals.hpp"
 #include "termui/termui.hpp"
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        std::cout << "Must pass <iface_name>\n";
-        exit(EXIT_FAILURE);
-    }
+    bandwit::OptionsParser parser{};
+    bandwit::Options opts = parser.parse(argc, argv);
 
-    std::string iface_name{argv[1]};
+    // there is an rx and a tx series for every window
+    std::size_t num_copies = 2;
+    bandwit::sampling::RetentionPlanner planner{opts.retain,
+                                                opts.memory_budget};
+    auto retentions = planner.plan(
+        bandwit::sampling::get_windows(opts.interval), num_copies);
+
+    if (opts.show_retention) {
+        std::cout << planner.format_report(retentions, num_copies);
+        return 0;
+    }
 
     // We expect to get a Ctrl+C. Install a SIGINT handler that throws an
     // exception such that we can unwind orderly and enter the catch block
@@ -22,7 +32,9 @@ int main(int argc, char *argv[]) {
     // uncaught exception will terminate the program bypassing all destructors
     // and leave the terminal in a corrupted state.
     try {
-        bandwit::termui::TermUi termui{iface_name};
+        bandwit::termui::TermUi termui{opts.iface_name, opts.interval,
+                                       retentions, opts.windows,
+                                       opts.data_dir};
         termui.run_forever();
     } catch (bandwit::termui::InterruptException &e) {
         // This is the expected way to stop the program.
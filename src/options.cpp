@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <cstdlib>
+#include <getopt.h>
+#include <iostream>
+#include <limits>
+
+#include "macros.hpp"
+#include "options.hpp"
+#include "sampling/agg_window.hpp"
+
+namespace bandwit {
+
+// 2^32 points of 8 bytes, which is 32 GiB
+static constexpr Millis::rep max_retain_points = Millis::rep{1} << 32;
+
+Options OptionsParser::parse(int argc, char *argv[]) const {
+    Options opts{};
+
+    const option long_opts[] = {
+        {"interval", required_argument, nullptr, 'i'},
+        {"windows", required_argument, nullptr, 'w'},
+        {"retain", required_argument, nullptr, 'r'},
+        {"memory-budget", required_argument, nullptr, 'm'},
+        {"show-retention", no_argument, nullptr, 'R'},
+        {"data-dir", required_argument, nullptr, 'd'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    int opt = 0;
+    while ((opt = getopt_long(argc, argv, "i:w:r:m:d:h", long_opts, nullptr)) !=
+           -1) {
+        if (opt == 'i') {
+            auto interval = parse_duration(optarg);
+
+            // The interval has to be one of the sub-second windows or one
+            // second, so that it lines up with the aggregation windows.
+            if (!interval.has_value() ||
+                !sampling::window_from_interval(interval.value()) ||
+                (interval.value() > Millis{1000})) {
+                exit_with_usage(argv[0], "interval must be one of: 100ms, "
+                                         "250ms, 500ms, 1s");
+            }
+
+            opts.interval = interval.value();
+
+        } else if (opt == 'w') {
+            auto windows = parse_windows(optarg);
+            if (!windows.has_value()) {
+                exit_with_usage(argv[0], "windows must look like: "
+                                         "1s,5s,1m,15m,1h,1d");
+            }
+
+            opts.windows = windows.value();
+
+        } else if (opt == 'r') {
+            auto retain = parse_retain(optarg);
+            if (!retain.has_value()) {
+                exit_with_usage(argv[0], "retain must look like: "
+                                         "1s=2h,1m=7d,1h=90d, with each "
+                                         "duration 1 to 2^32 windows long");
+            }
+
+            opts.retain = retain.value();
+
+        } else if (opt == 'm') {
+            auto budget = parse_size(optarg);
+            if (!budget.has_value() || (budget.value() == 0)) {
+                exit_with_usage(argv[0], "memory budget must be a size, eg. "
+                                         "512K, 64M, 1G");
+            }
+
+            opts.memory_budget = budget;
+
+        } else if (opt == 'R') {
+            opts.show_retention = true;
+
+        } else if (opt == 'd') {
+            opts.data_dir = std::string{optarg};
+
+        } else {
+            // --help or an unknown option
+            exit_with_usage(argv[0], "");
+        }
+    }
+
+    // we only keep time series for the windows that fit the interval
+    auto windows = sampling::get_windows(opts.interval);
+    for (const auto &pair : opts.retain) {
+        if (std::find(windows.begin(), windows.end(), pair.first) ==
+            windows.end()) {
+            exit_with_usage(argv[0], "cannot retain window " +
+                                         sampling::get_label(pair.first) +
+                                         " at this interval");
+        }
+    }
+
+    // Every bucket of a window is made up of whole samples. That makes it a
+    // multiple of the finest window we keep, so there's a series to answer it.
+    for (auto window : opts.windows) {
+        if (sampling::get_interval(window) % opts.interval != Millis{0}) {
+            exit_with_usage(argv[0], "cannot show window " +
+                                         sampling::get_label(window) +
+                                         " at this interval");
+        }
+    }
+
+    // the report doesn't depend on the interface
+    if (opts.show_retention) {
+        return opts;
+    }
+
+    if (optind >= argc) {
+        exit_with_usage(argv[0], "Must pass <iface_name>");
+    }
+
+    opts.iface_name = argv[optind];
+    return opts;
+}
+
+std::optional<Millis>
+OptionsParser::parse_duration(const std::string &str) const {
+    // a number followed by a unit, eg. 250ms, 1s, 2h, 7d
+    std::size_t num_digits = 0;
+    while ((num_digits < str.size()) && (str[num_digits] >= '0') &&
+           (str[num_digits] <= '9')) {
+        ++num_digits;
+    }
+
+    if ((num_digits == 0) || (num_digits > 12)) {
+        return std::nullopt;
+    }
+
+    auto num = Millis::rep{std::stoll(str.substr(0, num_digits))};
+    auto unit = str.substr(num_digits);
+
+    Millis::rep factor = 0;
+    if (unit == "ms") {
+        factor = 1;
+    } else if (unit == "s") {
+        factor = 1000;
+    } else if (unit == "m") {
+        factor = 60 * 1000;
+    } else if (unit == "h") {
+        factor = 3600 * 1000;
+    } else if (unit == "d") {
+        factor = 86400 * 1000;
+    } else {
+        return std::nullopt;
+    }
+
+    // 12 digits of days don't fit in the milliseconds
+    if (num > std::numeric_limits<Millis::rep>::max() / factor) {
+        return std::nullopt;
+    }
+
+    return Millis{num * factor};
+}
+
+std::optional<uint64_t>
+OptionsParser::parse_size(const std::string &str) const {
+    // a number of bytes, optionally followed by K, M or G
+    std::size_t num_digits = 0;
+    while ((num_digits < str.size()) && (str[num_digits] >= '0') &&
+           (str[num_digits] <= '9')) {
+        ++num_digits;
+    }
+
+    if ((num_digits == 0) || (num_digits > 12)) {
+        return std::nullopt;
+    }
+
+    auto num = U64(std::stoll(str.substr(0, num_digits)));
+    auto unit = str.substr(num_digits);
+
+    uint64_t shift = 0;
+    if (unit.empty()) {
+        shift = 0;
+    } else if (unit == "K") {
+        shift = 10;
+    } else if (unit == "M") {
+        shift = 20;
+    } else if (unit == "G") {
+        shift = 30;
+    } else {
+        return std::nullopt;
+    }
+
+    if (num > (std::numeric_limits<uint64_t>::max() >> shift)) {
+        return std::nullopt;
+    }
+
+    return num << shift;
+}
+
+std::optional<std::map<sampling::AggregationWindow, Millis>>
+OptionsParser::parse_retain(const std::string &str) const {
+    // a comma separated list of <window>=<duration>, eg. 1s=2h,1m=7d
+    std::map<sampling::AggregationWindow, Millis> retain{};
+    std::size_t pos = 0;
+
+    while (pos <= str.size()) {
+        auto end = str.find(',', pos);
+        if (end == std::string::npos) {
+            end = str.size();
+        }
+
+        auto item = str.substr(pos, end - pos);
+        auto eq = item.find('=');
+        if (eq == std::string::npos) {
+            return std::nullopt;
+        }
+
+        auto window_len = parse_duration(item.substr(0, eq));
+        auto duration = parse_duration(item.substr(eq + 1));
+        if (!window_len.has_value() || !duration.has_value()) {
+            return std::nullopt;
+        }
+
+        auto window = sampling::window_from_interval(window_len.value());
+        if (!window.has_value()) {
+            return std::nullopt;
+        }
+
+        // There has to be at least one point to keep, and no more than would
+        // fit in memory. Beyond that the spans and sizes we work out from the
+        // number of points overflow as well.
+        auto num_points = duration.value() / window_len.value();
+        if ((num_points < 1) || (num_points > max_retain_points)) {
+            return std::nullopt;
+        }
+
+        retain[window.value()] = duration.value();
+        pos = end + 1;
+    }
+
+    return retain;
+}
+
+std::optional<std::vector<sampling::AggregationWindow>>
+OptionsParser::parse_windows(const std::string &str) const {
+    // a comma separated list of durations, eg. 1s,5s,1m,15m
+    std::vector<sampling::AggregationWindow> windows{};
+    std::size_t pos = 0;
+
+    while (pos <= str.size()) {
+        auto end = str.find(',', pos);
+        if (end == std::string::npos) {
+            end = str.size();
+        }
+
+        // The length has to fit the enum, which holds an int. A week is as
+        // far as it makes sense to go.
+        auto length = parse_duration(str.substr(pos, end - pos));
+        if (!length.has_value() || (length.value() == Millis{0}) ||
+            (length.value() > Millis{7 * 86400 * 1000})) {
+            return std::nullopt;
+        }
+
+        windows.push_back(sampling::window_from_length(length.value()));
+        pos = end + 1;
+    }
+
+    // the arrow keys step through them finest first
+    std::sort(windows.begin(), windows.end());
+    windows.erase(std::unique(windows.begin(), windows.end()), windows.end());
+
+    return windows;
+}
+
+void OptionsParser::exit_with_usage(const char *prog,
+                                    const std::string &error) const {
+    if (!error.empty()) {
+        std::cerr << error << "\n\n";
+    }
+
+    std::cerr << "Usage: " << prog << " [options] <iface_name>\n"
+              << "\n"
+              << "Options:\n"
+              << "  -i, --interval <duration>  sampling interval: 100ms, "
+                 "250ms, 500ms or 1s\n"
+              << "                             (default: 1s)\n"
+              << "  -w, --windows <list>       the windows the arrow keys "
+                 "step through,\n"
+              << "                             eg. 1s,5s,1m,15m,1h,1d "
+                 "(default: the\n"
+              << "                             windows history is kept for)\n"
+              << "  -r, --retain <list>        how much history to keep per "
+                 "window,\n"
+              << "                             eg. 1s=2h,1m=7d,1h=90d "
+                 "(default: 512\n"
+              << "                             points per window)\n"
+              << "  -m, --memory-budget <size> memory for all the history "
+                 "together,\n"
+              << "                             eg. 64M\n"
+              << "      --show-retention       show how much history is kept "
+                 "and exit\n"
+              << "  -d, --data-dir <dir>       keep the history in files in "
+                 "<dir>, so that\n"
+              << "                             it survives a restart\n"
+              << "  -h, --help                 show this message\n";
+
+    exit(EXIT_FAILURE);
+}
+
+} // namespace bandwit
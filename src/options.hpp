@@ -0,0 +1,53 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "aliases.hpp"
+#include "sampling/agg_window.hpp"
+
+namespace bandwit {
+
+struct Options {
+    std::string iface_name{};
+
+    // how often to sample the interface
+    Millis interval{1000};
+
+    // the windows the arrow keys step through, if not the ones we keep
+    std::vector<sampling::AggregationWindow> windows{};
+
+    // how much history to keep for a window, if not the default
+    std::map<sampling::AggregationWindow, Millis> retain{};
+    // how much memory all the time series may use together, in bytes
+    std::optional<uint64_t> memory_budget{};
+    // print how much memory every time series uses and exit
+    bool show_retention{false};
+    // where to keep the history between runs
+    std::optional<std::string> data_dir{};
+};
+
+class OptionsParser {
+  public:
+    // Exits the program with a usage message if the arguments are invalid
+    Options parse(int argc, char *argv[]) const;
+
+    std::optional<Millis> parse_duration(const std::string &str) const;
+    std::optional<uint64_t> parse_size(const std::string &str) const;
+    std::optional<std::map<sampling::AggregationWindow, Millis>>
+    parse_retain(const std::string &str) const;
+    std::optional<std::vector<sampling::AggregationWindow>>
+    parse_windows(const std::string &str) const;
+
+  private:
+    [[noreturn]] void exit_with_usage(const char *prog,
+                                      const std::string &error) const;
+};
+
+} // namespace bandwit
+
+#endif // OPTIONS_H
@@ -1,10 +1,17 @@
 #include "sampling/agg_window.hpp"
+#include "macros.hpp"
 
 namespace bandwit {
 namespace sampling {
 
 AggregationWindow next_interval(AggregationWindow agg_window) {
     switch (agg_window) {
+    case AggregationWindow::HUNDRED_MILLIS:
+        return AggregationWindow::QUARTER_SECOND;
+    case AggregationWindow::QUARTER_SECOND:
+        return AggregationWindow::HALF_SECOND;
+    case AggregationWindow::HALF_SECOND:
+        return AggregationWindow::ONE_SECOND;
     case AggregationWindow::ONE_SECOND:
         return AggregationWindow::ONE_MINUTE;
     case AggregationWindow::ONE_MINUTE:
@@ -25,12 +32,24 @@ AggregationWindow prev_interval(AggregationWindow agg_window) {
     case AggregationWindow::ONE_MINUTE:
         return AggregationWindow::ONE_SECOND;
     case AggregationWindow::ONE_SECOND:
-        return AggregationWindow::ONE_SECOND;
+        return AggregationWindow::HALF_SECOND;
+    case AggregationWindow::HALF_SECOND:
+        return AggregationWindow::QUARTER_SECOND;
+    case AggregationWindow::QUARTER_SECOND:
+        return AggregationWindow::HUNDRED_MILLIS;
+    case AggregationWindow::HUNDRED_MILLIS:
+        return AggregationWindow::HUNDRED_MILLIS;
     }
 }
 
 std::string get_label(AggregationWindow agg_window) {
     switch (agg_window) {
+    case AggregationWindow::HUNDRED_MILLIS:
+        return "100ms";
+    case AggregationWindow::QUARTER_SECOND:
+        return "250ms";
+    case AggregationWindow::HALF_SECOND:
+        return "500ms";
     case AggregationWindow::ONE_SECOND:
         return "sec";
     case AggregationWindow::ONE_MINUTE:
@@ -40,7 +59,80 @@ std::string get_label(AggregationWindow agg_window) {
     case AggregationWindow::ONE_DAY:
         return "day";
     }
+
+    // not an enumerator, so name it after the largest unit it's a multiple of
+    auto length = INT(agg_window);
+    if (length % 86400000 == 0) {
+        return std::to_string(length / 86400000) + "d";
+    } else if (length % 3600000 == 0) {
+        return std::to_string(length / 3600000) + "h";
+    } else if (length % 60000 == 0) {
+        return std::to_string(length / 60000) + "m";
+    } else if (length % 1000 == 0) {
+        return std::to_string(length / 1000) + "s";
+    }
+    return std::to_string(length) + "ms";
+}
+
+Millis get_interval(AggregationWindow agg_window) {
+    return Millis{INT(agg_window)};
+}
+
+std::optional<AggregationWindow> window_from_interval(Millis interval) {
+    for (auto window = AggregationWindow::HUNDRED_MILLIS;;
+         window = next_interval(window)) {
+        if (get_interval(window) == interval) {
+            return window;
+        }
+        if (window == AggregationWindow::ONE_DAY) {
+            return std::nullopt;
+        }
+    }
+}
+
+AggregationWindow window_from_length(Millis length) {
+    return static_cast<AggregationWindow>(length.count());
+}
+
+std::optional<std::size_t> get_window_index(AggregationWindow agg_window) {
+    switch (agg_window) {
+    case AggregationWindow::HUNDRED_MILLIS:
+        return 0;
+    case AggregationWindow::QUARTER_SECOND:
+        return 1;
+    case AggregationWindow::HALF_SECOND:
+        return 2;
+    case AggregationWindow::ONE_SECOND:
+        return 3;
+    case AggregationWindow::ONE_MINUTE:
+        return 4;
+    case AggregationWindow::ONE_HOUR:
+        return 5;
+    case AggregationWindow::ONE_DAY:
+        return 6;
+    }
+    return std::nullopt;
+}
+
+std::vector<AggregationWindow> get_windows(Millis sampling_interval) {
+    std::vector<AggregationWindow> windows{};
+
+    // Every window has to be a whole number of sampling intervals, otherwise
+    // the buckets would not all hold the same number of samples.
+    for (auto window = AggregationWindow::HUNDRED_MILLIS;;
+         window = next_interval(window)) {
+        auto window_interval = get_interval(window);
+        if ((window_interval >= sampling_interval) &&
+            (window_interval % sampling_interval == Millis{0})) {
+            windows.push_back(window);
+        }
+        if (window == AggregationWindow::ONE_DAY) {
+            break;
+        }
+    }
+
+    return windows;
 }
 
 } // namespace sampling
-} // namespace bandwit
\ No newline at end of file
+} // namespace bandwit
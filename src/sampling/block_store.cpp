@@ -0,0 +1,133 @@
+#include <stdexcept>
+
+#include "block_store.hpp"
+#include "except.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+void BlockCodec::encode(const uint64_t *values, std::size_t len,
+                        std::vector<uint8_t> &out) const {
+    out.clear();
+
+    uint64_t prev = 0;
+    for (std::size_t i = 0; i < len; ++i) {
+        auto delta = values[i] - prev;
+        auto zigzag = (delta << 1) ^ U64(static_cast<int64_t>(delta) >> 63);
+        put_varint(zigzag, out);
+        prev = values[i];
+    }
+}
+
+void BlockCodec::decode(const std::vector<uint8_t> &in, uint64_t *values,
+                        std::size_t len) const {
+    const uint8_t *cur = in.data();
+
+    uint64_t prev = 0;
+    for (std::size_t i = 0; i < len; ++i) {
+        auto zigzag = get_varint(cur);
+        auto delta = (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+        prev += delta;
+        values[i] = prev;
+    }
+}
+
+void BlockCodec::put_varint(uint64_t num, std::vector<uint8_t> &out) {
+    while (num >= 0x80) {
+        out.push_back(static_cast<uint8_t>(num | 0x80));
+        num >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(num));
+}
+
+uint64_t BlockCodec::get_varint(const uint8_t *&cur) {
+    uint64_t num = 0;
+    int shift = 0;
+
+    while (*cur & 0x80) {
+        num |= U64(*cur & 0x7f) << shift;
+        shift += 7;
+        ++cur;
+    }
+    num |= U64(*cur) << shift;
+    ++cur;
+
+    return num;
+}
+
+BlockStore::BlockStore(std::size_t block_size, std::size_t num_blocks)
+    : block_size_{block_size}, mask_{num_blocks - 1} {
+    if ((num_blocks == 0) || ((num_blocks & mask_) != 0)) {
+        THROW_ARGS(std::runtime_error,
+                   "number of blocks must be a power of two, got: %zu",
+                   num_blocks);
+    }
+
+    blocks_.resize(num_blocks);
+}
+
+void BlockStore::seal(std::size_t block_index, const uint64_t *values,
+                      uint64_t base) {
+    auto &block = blocks_[block_index & mask_];
+
+    // Encode into the scratch buffer first, so the block only grows to what
+    // it needs rather than to the next doubling.
+    codec_.encode(values, block_size_, scratch_);
+    block.bytes.assign(scratch_.begin(), scratch_.end());
+    block.index = block_index;
+    block.is_valid = true;
+    block.base = base;
+}
+
+void BlockStore::seal_empty(std::size_t block_index, uint64_t base) {
+    auto &block = blocks_[block_index & mask_];
+
+    // every delta is zero, which is encoded as a single zero byte
+    block.bytes.assign(block_size_, 0);
+    block.index = block_index;
+    block.is_valid = true;
+    block.base = base;
+}
+
+bool BlockStore::contains(std::size_t block_index) const {
+    const auto &block = blocks_[block_index & mask_];
+    return block.is_valid && (block.index == block_index);
+}
+
+void BlockStore::decode(std::size_t block_index, uint64_t *values) const {
+    if (!contains(block_index)) {
+        THROW_ARGS(std::out_of_range, "block not in store: %zu", block_index);
+    }
+
+    const auto &block = blocks_[block_index & mask_];
+    codec_.decode(block.bytes, values, block_size_);
+}
+
+uint64_t BlockStore::get_base(std::size_t block_index) const {
+    if (!contains(block_index)) {
+        THROW_ARGS(std::out_of_range, "block not in store: %zu", block_index);
+    }
+
+    return blocks_[block_index & mask_].base;
+}
+
+void BlockStore::adjust_bases_after(std::size_t block_index, uint64_t delta) {
+    // The sums wrap around, so adding the two's complement of a decrease
+    // works as well.
+    for (auto &block : blocks_) {
+        if (block.is_valid && (block.index > block_index)) {
+            block.base += delta;
+        }
+    }
+}
+
+std::size_t BlockStore::memory_usage() const {
+    std::size_t total = blocks_.size() * sizeof(Block) + scratch_.capacity();
+    for (const auto &block : blocks_) {
+        total += block.bytes.capacity();
+    }
+    return total;
+}
+
+} // namespace sampling
+} // namespace bandwit
@@ -0,0 +1,72 @@
+#ifndef BLOCK_STORE_H
+#define BLOCK_STORE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "macros.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+// Encodes a block of values as the difference to the previous value. The
+// difference is zigzag encoded, so that small negative differences stay
+// small, and written in as few bytes as it takes (7 bits per byte). Idle or
+// steady traffic comes out at about one byte per value.
+class BlockCodec {
+  public:
+    void encode(const uint64_t *values, std::size_t len,
+                std::vector<uint8_t> &out) const;
+    void decode(const std::vector<uint8_t> &in, uint64_t *values,
+                std::size_t len) const;
+
+  private:
+    static void put_varint(uint64_t num, std::vector<uint8_t> &out);
+    static uint64_t get_varint(const uint8_t *&cur);
+};
+
+// Sealed blocks of a time series, each holding `block_size` values in encoded
+// form. Blocks are identified by their index (key / block_size) and kept in a
+// ring with room for `num_blocks`, so sealing a block overwrites the oldest.
+//
+// Every block also records its base: the sum of all the values before it.
+// The sum of the values before any key is then the base of its block plus a
+// partial sum within the block, which makes the sum over a range of keys a
+// subtraction.
+class BlockStore {
+  public:
+    // `num_blocks` has to be a power of two
+    BlockStore(std::size_t block_size, std::size_t num_blocks);
+
+    void seal(std::size_t block_index, const uint64_t *values, uint64_t base);
+    void seal_empty(std::size_t block_index, uint64_t base);
+
+    bool contains(std::size_t block_index) const;
+    void decode(std::size_t block_index, uint64_t *values) const;
+    uint64_t get_base(std::size_t block_index) const;
+
+    // for when a value in a block changed after blocks after it were sealed
+    void adjust_bases_after(std::size_t block_index, uint64_t delta);
+
+    std::size_t memory_usage() const;
+
+  private:
+    struct Block {
+        std::size_t index;
+        bool is_valid;
+        uint64_t base;
+        std::vector<uint8_t> bytes;
+    };
+
+    BlockCodec codec_{};
+
+    std::size_t block_size_{0};
+    std::size_t mask_{0};
+    std::vector<Block> blocks_{};
+    std::vector<uint8_t> scratch_{};
+};
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // BLOCK_STORE_H
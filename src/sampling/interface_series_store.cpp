@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+#include "except.hpp"
+#include "interface_series_store.hpp"
+#include "macros.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+InterfaceSeriesStore::InterfaceSeriesStore(
+    TimePoint tp, const std::vector<Retention> &retentions) {
+    std::size_t prev = num_windows;
+
+    for (const auto &retention : retentions) {
+        auto window = retention.window;
+        auto interval = get_interval(window);
+
+        auto index = get_window_index(window);
+        if (!index.has_value()) {
+            THROW_ARGS(std::runtime_error, "cannot keep a time series for: %s",
+                       get_label(window).c_str());
+        }
+
+        // A bucket can only be rolled up if it falls entirely within a bucket
+        // of the next level.
+        if (prev != num_windows) {
+            auto prev_window = levels_[prev].window;
+            auto prev_interval = get_interval(prev_window);
+            if ((interval <= prev_interval) ||
+                (interval % prev_interval != Millis{0})) {
+                THROW_ARGS(std::runtime_error,
+                           "window %s is not a multiple of window %s",
+                           get_label(window).c_str(),
+                           get_label(prev_window).c_str());
+            }
+            levels_[prev].next = index.value();
+        } else {
+            finest_ = index.value();
+        }
+
+        auto &lvl = levels_[index.value()];
+        lvl.window = window;
+        lvl.series = std::make_unique<TimeSeries>(
+            interval, tp, retention.capacity, num_metrics);
+
+        // The finest level has a single sample per bucket, which doesn't
+        // need a sketch. The ring is indexed by key, so its size has to be a
+        // power of two.
+        if ((prev != num_windows) && (retention.sketch_slots > 0)) {
+            auto slots = std::min(retention.sketch_slots, retention.capacity);
+            if ((slots & (slots - 1)) != 0) {
+                THROW_ARGS(std::runtime_error,
+                           "sketch slots not a power of two: %zu", slots);
+            }
+            lvl.sketches.resize(slots);
+        }
+
+        prev = index.value();
+    }
+
+    if (finest_ == num_windows) {
+        THROW_MSG(std::runtime_error, "no time series to keep");
+    }
+}
+
+void InterfaceSeriesStore::inc(TimePoint tp, const MetricValues &values) {
+    add_to_bucket(finest_, tp, values);
+}
+
+void InterfaceSeriesStore::open_bucket(std::size_t level, TimePoint tp) {
+    auto &lvl = levels_[level];
+    auto key = lvl.series->calculate_key(tp);
+
+    if (lvl.is_open && (key <= lvl.open_key)) {
+        return;
+    }
+
+    bool has_next = lvl.next != num_windows;
+
+    // Roll the bucket we're closing up into the next level. Its samples go
+    // into the sketch of the bucket that received its value.
+    if (lvl.is_open && has_next) {
+        auto closed_tp = lvl.series->reverse_key(lvl.open_key);
+        add_to_bucket(lvl.next, closed_tp, lvl.open_values);
+
+        auto &next = levels_[lvl.next];
+        for (std::size_t metric = 0; metric < num_metrics; ++metric) {
+            if (level == finest_) {
+                next.open_sketches[metric].add(lvl.open_values[metric], 1);
+            } else {
+                next.open_sketches[metric].merge(lvl.open_sketches[metric]);
+            }
+        }
+    }
+
+    if (lvl.is_open) {
+        close_sketches(level);
+    }
+
+    // The bucket of the next level has to contain the one we're opening,
+    // otherwise the traffic pending in this level would be shown in the wrong
+    // bucket of the next level.
+    if (has_next) {
+        open_bucket(lvl.next, tp);
+    }
+
+    lvl.is_open = true;
+    lvl.open_key = key;
+    lvl.open_values.fill(0);
+
+    // make the bucket exist, so that it's included in slices right away
+    lvl.series->inc(tp, lvl.open_values.data());
+
+    for (auto &file : lvl.files) {
+        if (file) {
+            file->append(lvl.series->reverse_key(key), 0);
+        }
+    }
+}
+
+void InterfaceSeriesStore::add_to_bucket(std::size_t level, TimePoint tp,
+                                         const MetricValues &values) {
+    auto &lvl = levels_[level];
+
+    open_bucket(level, tp);
+
+    // Should the values belong to a bucket we've already closed they go into
+    // the open one, since it can no longer be rolled up.
+    auto open_tp = lvl.series->reverse_key(lvl.open_key);
+    lvl.series->inc(open_tp, values.data());
+
+    for (std::size_t metric = 0; metric < num_metrics; ++metric) {
+        lvl.open_values[metric] += values[metric];
+
+        if (lvl.files[metric]) {
+            lvl.files[metric]->update_last(lvl.open_values[metric]);
+        }
+    }
+}
+
+void InterfaceSeriesStore::close_sketches(std::size_t level) {
+    auto &lvl = levels_[level];
+    if (lvl.sketches.empty()) {
+        return;
+    }
+
+    auto &slot = lvl.sketches[lvl.open_key & (lvl.sketches.size() - 1)];
+    slot.key = lvl.open_key;
+    slot.is_valid = true;
+    slot.sketches = lvl.open_sketches;
+
+    for (auto &sketch : lvl.open_sketches) {
+        sketch.clear();
+    }
+}
+
+void InterfaceSeriesStore::attach_files(const std::string &path_prefix) {
+    for (auto &lvl : levels_) {
+        if (!lvl.series) {
+            continue;
+        }
+
+        if (lvl.is_open) {
+            THROW_MSG(std::runtime_error,
+                      "cannot attach files to a store in use");
+        }
+
+        for (std::size_t metric = 0; metric < num_metrics; ++metric) {
+            auto filepath = path_prefix + "-" +
+                            get_label(static_cast<Metric>(metric)) + "-" +
+                            get_label(lvl.window) + ".bws";
+            lvl.files[metric] = std::make_unique<SeriesFile>(
+                filepath, get_interval(lvl.window), lvl.series->capacity());
+        }
+
+        replay_files(lvl);
+    }
+}
+
+void InterfaceSeriesStore::sync_files() {
+    for (auto &lvl : levels_) {
+        for (auto &file : lvl.files) {
+            if (file) {
+                file->sync();
+            }
+        }
+    }
+}
+
+void InterfaceSeriesStore::replay_files(Level &lvl) {
+    // The metrics share the keys of the series, so they are replayed together,
+    // key by key. Every key is then written while its block is still the hot
+    // one, rather than into a sealed block.
+    //
+    // The files of the metrics are written together, so their records line
+    // up. After a crash one may have a record that another doesn't, so they
+    // are merged by time. A metric without a record for a bucket had no
+    // traffic in it.
+    std::array<std::size_t, num_metrics> next{};
+    std::array<std::size_t, num_metrics> num_records{};
+
+    // only as much as the series can hold
+    auto capacity = lvl.series->capacity();
+    for (std::size_t metric = 0; metric < num_metrics; ++metric) {
+        num_records[metric] = lvl.files[metric]->size();
+        next[metric] = num_records[metric] > capacity
+                           ? num_records[metric] - capacity
+                           : 0;
+    }
+
+    bool has_records = false;
+    TimePoint last_tp{};
+    MetricValues values{};
+
+    while (true) {
+        // the oldest bucket any of the files has left
+        std::optional<int64_t> time_ms{};
+        for (std::size_t metric = 0; metric < num_metrics; ++metric) {
+            if (next[metric] < num_records[metric]) {
+                auto record_ms = lvl.files[metric]->get(next[metric]).time_ms;
+                if (!time_ms.has_value() || (record_ms < time_ms.value())) {
+                    time_ms = record_ms;
+                }
+            }
+        }
+
+        if (!time_ms.has_value()) {
+            break;
+        }
+
+        values.fill(0);
+        for (std::size_t metric = 0; metric < num_metrics; ++metric) {
+            if (next[metric] < num_records[metric]) {
+                const auto &record = lvl.files[metric]->get(next[metric]);
+                if (record.time_ms == time_ms.value()) {
+                    values[metric] = record.value;
+                    ++next[metric];
+                }
+            }
+        }
+
+        last_tp = TimePoint{Millis{time_ms.value()}};
+        lvl.series->set_key(lvl.series->calculate_key(last_tp), values.data());
+        has_records = true;
+    }
+
+    if (!has_records) {
+        return;
+    }
+
+    // The last record is the bucket that was open when we stopped. It carries
+    // on from where it was, and anything that comes in after it closes it.
+    lvl.is_open = true;
+    lvl.open_key = lvl.series->calculate_key(last_tp);
+    lvl.open_values = values;
+}
+
+const InterfaceSeriesStore::Level &
+InterfaceSeriesStore::get_level(AggregationWindow window) const {
+    auto index = get_window_index(window);
+    if (index.has_value() && levels_[index.value()].series) {
+        return levels_[index.value()];
+    }
+
+    // the coarsest level whose buckets add up to the window
+    auto interval = get_interval(window);
+    for (auto it = levels_.rbegin(); it != levels_.rend(); ++it) {
+        if (!it->series) {
+            continue;
+        }
+
+        auto level_interval = get_interval(it->window);
+        if ((interval >= level_interval) &&
+            (interval % level_interval == Millis{0})) {
+            return *it;
+        }
+    }
+
+    THROW_ARGS(std::out_of_range, "no time series for window: %s",
+               get_label(window).c_str());
+}
+
+uint64_t InterfaceSeriesStore::get_pending(const Level &level,
+                                           std::size_t metric) const {
+    // The open buckets of the finer levels all fall within the open bucket of
+    // this level, but have not been rolled up into it yet.
+    uint64_t pending = 0;
+
+    for (auto finer = finest_; &levels_[finer] != &level;
+         finer = levels_[finer].next) {
+        pending += levels_[finer].open_values[metric];
+    }
+
+    return pending;
+}
+
+void InterfaceSeriesStore::get_slice_from_point(Metric metric,
+                                                AggregationWindow window,
+                                                TimePoint tp, std::size_t len,
+                                                Statistic stat,
+                                                TimeSeriesSlice &slice) const {
+    const auto &lvl = get_level(window);
+    auto column = SIZE_T(metric);
+
+    if (is_distribution(stat)) {
+        get_distribution_slice(lvl, column, window, tp, len, stat, slice);
+        return;
+    }
+
+    lvl.series->get_slice_from_point(column, tp, len, get_interval(window),
+                                     stat, get_pending(lvl, column), slice);
+}
+
+void InterfaceSeriesStore::get_distribution_slice(
+    const Level &lvl, std::size_t metric, AggregationWindow window,
+    TimePoint tp, std::size_t len, Statistic stat,
+    TimeSeriesSlice &slice) const {
+    auto level = SIZE_T(&lvl - levels_.data());
+    const auto &ts = lvl.series;
+    auto interval = get_interval(window);
+
+    // the same buckets as the sum, with the values replaced
+    ts->get_slice_from_point(metric, tp, len, interval, Statistic::SUM, 0,
+                             slice);
+
+    auto factor = SIZE_T(interval / get_interval(lvl.window));
+    auto min_key = ts->calculate_key(ts->min(get_interval(lvl.window)));
+    auto max_key = ts->calculate_key(ts->max(get_interval(lvl.window)));
+
+    // the samples are per sampling interval, but we show them per second
+    auto sample_ms = U64(get_interval(levels_[finest_].window).count());
+
+    auto &sketch = column_sketch_;
+    for (std::size_t i = 0; i < slice.size(); ++i) {
+        // The first bucket may start before the oldest key we have, so the
+        // ends are clamped each on their own.
+        auto bucket_key = ts->calculate_key(slice.time_point(i));
+        auto first_key = std::max(bucket_key, min_key);
+        auto last_key = std::min(bucket_key + factor - 1, max_key);
+
+        sketch.clear();
+        for (auto key = first_key; key <= last_key; ++key) {
+            merge_sketch(level, metric, key, sketch);
+        }
+
+        uint64_t value = 0;
+        if (stat == Statistic::MAX) {
+            value = sketch.max();
+        } else if (stat == Statistic::MIN) {
+            value = sketch.min();
+        } else if (stat == Statistic::P95) {
+            value = sketch.quantile(0.95);
+        } else if (stat == Statistic::P99) {
+            value = sketch.quantile(0.99);
+        }
+
+        slice.values[i] = value * 1000 / sample_ms;
+    }
+}
+
+void InterfaceSeriesStore::merge_sketch(std::size_t level, std::size_t metric,
+                                        std::size_t key,
+                                        QuantileSketch &sketch) const {
+    const auto &lvl = levels_[level];
+
+    // a bucket of the finest level is a single sample
+    if (level == finest_) {
+        sketch.add(lvl.series->get_key(key, metric), 1);
+        return;
+    }
+
+    auto count = sketch.count();
+
+    if (lvl.is_open && (key == lvl.open_key)) {
+        sketch.merge(lvl.open_sketches[metric]);
+
+        // the open buckets of the finer levels have not been rolled up yet
+        for (auto finer = finest_; finer != level;
+             finer = levels_[finer].next) {
+            const auto &finer_lvl = levels_[finer];
+            if (finer == finest_) {
+                if (finer_lvl.is_open) {
+                    sketch.add(finer_lvl.open_values[metric], 1);
+                }
+            } else {
+                sketch.merge(finer_lvl.open_sketches[metric]);
+            }
+        }
+    } else if (!lvl.sketches.empty()) {
+        const auto &slot = lvl.sketches[key & (lvl.sketches.size() - 1)];
+        if (slot.is_valid && (slot.key == key)) {
+            sketch.merge(slot.sketches[metric]);
+        }
+    }
+
+    // Without a sketch, because the bucket is too old or was loaded from a
+    // file, all we know is its sum. Count it as samples at the average.
+    auto value = lvl.series->get_key(key, metric);
+    if ((sketch.count() == count) && (value > 0)) {
+        auto num_samples = U32(get_interval(lvl.window) /
+                               get_interval(levels_[finest_].window));
+        sketch.add(value / num_samples, num_samples);
+    }
+}
+
+TimePoint InterfaceSeriesStore::min(AggregationWindow window) const {
+    const auto &ts = get_level(window).series;
+    return ts->min(get_interval(window));
+}
+
+TimePoint InterfaceSeriesStore::max(AggregationWindow window) const {
+    const auto &ts = get_level(window).series;
+    return ts->max(get_interval(window));
+}
+
+std::optional<TimePoint>
+InterfaceSeriesStore::minus_one(AggregationWindow window, TimePoint tp) const {
+    const auto &ts = get_level(window).series;
+    return ts->minus_one(tp, get_interval(window));
+}
+
+std::optional<TimePoint>
+InterfaceSeriesStore::plus_one(AggregationWindow window, TimePoint tp) const {
+    const auto &ts = get_level(window).series;
+    return ts->plus_one(tp, get_interval(window));
+}
+
+std::size_t InterfaceSeriesStore::memory_usage() const {
+    std::size_t total = 0;
+    for (const auto &lvl : levels_) {
+        if (!lvl.series) {
+            continue;
+        }
+
+        total += lvl.series->memory_usage();
+        for (const auto &sketch : lvl.open_sketches) {
+            total += sketch.memory_usage();
+        }
+        for (const auto &slot : lvl.sketches) {
+            total += sizeof(KeyedSketches) - sizeof(MetricSketches);
+            for (const auto &sketch : slot.sketches) {
+                total += sketch.memory_usage();
+            }
+        }
+    }
+    return total;
+}
+
+} // namespace sampling
+} // namespace bandwit
@@ -0,0 +1,123 @@
+#ifndef INTERFACE_SERIES_STORE_H
+#define INTERFACE_SERIES_STORE_H
+
+#include <array>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "aliases.hpp"
+#include "quantile_sketch.hpp"
+#include "sampling/agg_window.hpp"
+#include "sampling/metric.hpp"
+#include "sampling/retention.hpp"
+#include "sampling/series_file.hpp"
+#include "sampling/statistic.hpp"
+#include "sampling/time_series_slice.hpp"
+#include "time_series.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+// Keeps the history of every metric of an interface, with a time series per
+// aggregation window. The metrics are columns of the same time series, so a
+// sample updates all of them at once.
+//
+// Samples are only written to the finest series, and every bucket that closes
+// is rolled up into the next coarser series, so the work per sample does not
+// grow with the number of windows.
+//
+// Any window that is a multiple of a kept window can be queried as well. It is
+// answered from the coarsest series it is a multiple of.
+//
+// For the statistics over the distribution of the samples (MAX, P95, ...)
+// every bucket above the finest level also has a quantile sketch of the
+// samples in it, which is merged into the next level as the bucket is rolled
+// up. Sketches are only kept in memory and for the most recent buckets, older
+// buckets count as samples at their average.
+class InterfaceSeriesStore {
+  public:
+    explicit InterfaceSeriesStore(TimePoint tp,
+                                  const std::vector<Retention> &retentions);
+
+    void inc(TimePoint tp, const MetricValues &values);
+    void get_slice_from_point(Metric metric, AggregationWindow window,
+                              TimePoint tp, std::size_t len, Statistic stat,
+                              TimeSeriesSlice &slice) const;
+
+    TimePoint min(AggregationWindow window) const;
+    TimePoint max(AggregationWindow window) const;
+    std::optional<TimePoint> minus_one(AggregationWindow window,
+                                       TimePoint tp) const;
+    std::optional<TimePoint> plus_one(AggregationWindow window,
+                                      TimePoint tp) const;
+
+    std::size_t memory_usage() const;
+
+    // Keeps every metric of every series in a file named after `path_prefix`,
+    // the metric and the window, and loads the history that is already there.
+    // Has to be called before anything is added.
+    void attach_files(const std::string &path_prefix);
+    // asks for the files to be written back, without waiting for it
+    void sync_files();
+
+  private:
+    using MetricSketches = std::array<QuantileSketch, num_metrics>;
+
+    struct KeyedSketches {
+        std::size_t key{0};
+        bool is_valid{false};
+        MetricSketches sketches{};
+    };
+
+    struct Level {
+        AggregationWindow window{};
+        // nullptr if we don't keep this window
+        std::unique_ptr<TimeSeries> series{nullptr};
+        // the next coarser level we keep, or num_windows
+        std::size_t next{num_windows};
+
+        // the bucket that is still receiving traffic and has not been rolled
+        // up into the next level yet
+        bool is_open{false};
+        std::size_t open_key{0};
+        MetricValues open_values{};
+        MetricSketches open_sketches{};
+
+        // the sketches of the closed buckets, in a ring indexed by key
+        std::vector<KeyedSketches> sketches{};
+
+        // where the metrics are persisted, if anywhere
+        std::array<std::unique_ptr<SeriesFile>, num_metrics> files{};
+    };
+
+    void replay_files(Level &lvl);
+
+    void open_bucket(std::size_t level, TimePoint tp);
+    void add_to_bucket(std::size_t level, TimePoint tp,
+                       const MetricValues &values);
+    void close_sketches(std::size_t level);
+
+    const Level &get_level(AggregationWindow window) const;
+    uint64_t get_pending(const Level &level, std::size_t metric) const;
+
+    void get_distribution_slice(const Level &level, std::size_t metric,
+                                AggregationWindow window, TimePoint tp,
+                                std::size_t len, Statistic stat,
+                                TimeSeriesSlice &slice) const;
+    void merge_sketch(std::size_t level, std::size_t metric, std::size_t key,
+                      QuantileSketch &sketch) const;
+
+    // indexed by window, only the ones we keep have a series
+    std::array<Level, num_windows> levels_{};
+    std::size_t finest_{num_windows};
+
+    // the samples of a single bucket of a slice, kept to reuse its bins
+    mutable QuantileSketch column_sketch_{};
+};
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // INTERFACE_SERIES_STORE_H
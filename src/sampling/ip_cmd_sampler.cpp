@@ -79,9 +79,8 @@ IpStatsParser::parse(const std::vector<std::string> &lines,
               "failed to find the right iface / parse output");
 }
 
-Sample IpCommandSampler::get_sample(const std::string &iface_name) const {
-    auto tp = Clock::now();
-    std::time_t ts = Clock::to_time_t(tp);
+Sample IpCommandSampler::get_sample(const std::string &iface_name) {
+    TimePoint ts = Clock::now();
 
     std::stringstream ss{};
     ss << "ip -statistics link show dev " << iface_name;
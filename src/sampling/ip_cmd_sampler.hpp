@@ -31,7 +31,7 @@ class IpCommandSampler : public Sampler {
     CLASS_DISABLE_COPIES(IpCommandSampler)
     CLASS_DISABLE_MOVES(IpCommandSampler)
 
-    Sample get_sample(const std::string &iface_name) const override;
+    Sample get_sample(const std::string &iface_name) override;
 
   private:
     ProgramRunner runner_{};
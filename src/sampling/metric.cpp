@@ -0,0 +1,18 @@
+#include "sampling/metric.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+std::string get_label(Metric metric) {
+    switch (metric) {
+    case Metric::RX_BYTES:
+        return "rx";
+    case Metric::TX_BYTES:
+        return "tx";
+    }
+
+    return "N/A";
+}
+
+} // namespace sampling
+} // namespace bandwit
@@ -0,0 +1,410 @@
+#ifdef __linux__
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <linux/if_link.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <stdexcept>
+#include <sys/socket.h>
+
+#include "aliases.hpp"
+#include "except.hpp"
+#include "netlink_sampler.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+// Netlink headers and attributes are padded to 4 bytes. We don't use the
+// NLMSG_* / RTA_* macros because they are riddled with C style casts, and we
+// memcpy the structs out of the buffer because attribute payloads are not
+// guaranteed to be aligned for 64bit reads.
+static constexpr std::size_t nl_align(std::size_t len) {
+    return (len + 3U) & ~std::size_t{3U};
+}
+
+// Up to this many interfaces a request per interface is cheaper than having
+// the kernel dump every interface on the system.
+static constexpr std::size_t max_targeted_links = 2;
+
+bool NetlinkParser::parse_link(const char *msg, std::size_t len,
+                               LinkStats &stats) const {
+    nlmsghdr nh{};
+    ifinfomsg ifi{};
+
+    std::size_t offset = nl_align(sizeof(nh));
+    if (len < offset + sizeof(ifi)) {
+        return false;
+    }
+
+    memcpy(&nh, msg, sizeof(nh));
+    if (nh.nlmsg_type != RTM_NEWLINK) {
+        return false;
+    }
+
+    memcpy(&ifi, msg + offset, sizeof(ifi));
+    offset += nl_align(sizeof(ifi));
+
+    stats.ifindex = ifi.ifi_index;
+    stats.name.fill('\0');
+
+    bool found_stats64 = false;
+    bool found_stats32 = false;
+
+    while (offset + sizeof(rtattr) <= len) {
+        rtattr rta{};
+        memcpy(&rta, msg + offset, sizeof(rta));
+
+        if ((rta.rta_len < sizeof(rta)) || (offset + rta.rta_len > len)) {
+            break;
+        }
+
+        const char *payload = msg + offset + nl_align(sizeof(rta));
+        std::size_t payload_len = rta.rta_len - nl_align(sizeof(rta));
+
+        if (rta.rta_type == IFLA_IFNAME) {
+            auto name_len = std::min(payload_len, stats.name.size() - 1);
+            memcpy(stats.name.data(), payload, name_len);
+
+        } else if ((rta.rta_type == IFLA_STATS64) &&
+            (payload_len >= sizeof(rtnl_link_stats64))) {
+            rtnl_link_stats64 link_stats{};
+            memcpy(&link_stats, payload, sizeof(link_stats));
+
+            stats.rx = link_stats.rx_bytes;
+            stats.tx = link_stats.tx_bytes;
+            found_stats64 = true;
+
+        } else if ((rta.rta_type == IFLA_STATS) && !found_stats64 &&
+                   (payload_len >= sizeof(rtnl_link_stats))) {
+            // only used on kernels that are too old to send IFLA_STATS64
+            rtnl_link_stats link_stats{};
+            memcpy(&link_stats, payload, sizeof(link_stats));
+
+            stats.rx = link_stats.rx_bytes;
+            stats.tx = link_stats.tx_bytes;
+            found_stats32 = true;
+        }
+
+        offset += nl_align(rta.rta_len);
+    }
+
+    return found_stats64 || found_stats32;
+}
+
+NetlinkSampler::NetlinkSampler() {
+    fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd_ < 0) {
+        THROW_CERROR(std::runtime_error,
+                     "NetlinkSampler failed to create socket()");
+    }
+
+    // Never hang the sampling loop waiting for the kernel
+    struct timeval timeout {
+        1, 0
+    };
+    if (setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) <
+        0) {
+        close(fd_);
+        THROW_CERROR(std::runtime_error,
+                     "NetlinkSampler failed in setsockopt()");
+    }
+}
+
+NetlinkSampler::~NetlinkSampler() { close(fd_); }
+
+void NetlinkSampler::send_getlink(const std::string &iface_name) {
+    std::size_t name_len = iface_name.size() + 1;
+    if (name_len > IFNAMSIZ) {
+        THROW_ARGS(std::runtime_error, "interface name too long: %s",
+                   iface_name.c_str());
+    }
+
+    nlmsghdr nh{};
+    ifinfomsg ifi{};
+    rtattr rta{};
+
+    // nlmsghdr | ifinfomsg | rtattr IFLA_IFNAME | name
+    std::size_t offset_ifi = nl_align(sizeof(nh));
+    std::size_t offset_rta = offset_ifi + nl_align(sizeof(ifi));
+    std::size_t offset_name = offset_rta + nl_align(sizeof(rta));
+    std::size_t total = offset_name + nl_align(name_len);
+
+    nh.nlmsg_len = U32(total);
+    nh.nlmsg_type = RTM_GETLINK;
+    nh.nlmsg_flags = NLM_F_REQUEST;
+    nh.nlmsg_seq = ++seq_;
+
+    ifi.ifi_family = AF_UNSPEC;
+
+    rta.rta_type = IFLA_IFNAME;
+    rta.rta_len = U16(nl_align(sizeof(rta)) + name_len);
+
+    std::array<char, 128> req{};
+    memcpy(req.data(), &nh, sizeof(nh));
+    memcpy(req.data() + offset_ifi, &ifi, sizeof(ifi));
+    memcpy(req.data() + offset_rta, &rta, sizeof(rta));
+    memcpy(req.data() + offset_name, iface_name.c_str(), name_len);
+
+    send_request(req.data(), total);
+}
+
+void NetlinkSampler::send_getlink_dump() {
+    nlmsghdr nh{};
+    ifinfomsg ifi{};
+
+    // nlmsghdr | ifinfomsg
+    std::size_t offset_ifi = nl_align(sizeof(nh));
+    std::size_t total = offset_ifi + nl_align(sizeof(ifi));
+
+    nh.nlmsg_len = U32(total);
+    nh.nlmsg_type = RTM_GETLINK;
+    nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    nh.nlmsg_seq = ++seq_;
+
+    ifi.ifi_family = AF_UNSPEC;
+
+    std::array<char, 64> req{};
+    memcpy(req.data(), &nh, sizeof(nh));
+    memcpy(req.data() + offset_ifi, &ifi, sizeof(ifi));
+
+    send_request(req.data(), total);
+}
+
+void NetlinkSampler::send_request(const char *req, std::size_t len) {
+    sockaddr_nl kernel{};
+    kernel.nl_family = AF_NETLINK;
+
+    if (sendto(fd_, req, len, 0, reinterpret_cast<sockaddr *>(&kernel),
+               sizeof(kernel)) < 0) {
+        THROW_CERROR(std::runtime_error, "NetlinkSampler failed in sendto()");
+    }
+}
+
+LinkStats NetlinkSampler::receive_link() {
+    while (true) {
+        auto nread = recv(fd_, buffer_.data(), buffer_.size(), 0);
+        if (nread < 0) {
+            THROW_CERROR(std::runtime_error, "NetlinkSampler failed in recv()");
+        }
+
+        auto len = SIZE_T(nread);
+        std::size_t offset = 0;
+
+        while (offset + sizeof(nlmsghdr) <= len) {
+            const char *msg = buffer_.data() + offset;
+
+            nlmsghdr nh{};
+            memcpy(&nh, msg, sizeof(nh));
+
+            if ((nh.nlmsg_len < sizeof(nh)) || (offset + nh.nlmsg_len > len)) {
+                THROW_MSG(std::runtime_error,
+                          "NetlinkSampler received a truncated message");
+            }
+
+            // Skip replies to earlier requests that we gave up on
+            if (nh.nlmsg_seq == seq_) {
+                if (nh.nlmsg_type == NLMSG_ERROR) {
+                    nlmsgerr err{};
+                    memcpy(&err, msg + nl_align(sizeof(nh)), sizeof(err));
+
+                    errno = -err.error;
+                    THROW_CERROR(std::runtime_error,
+                                 "NetlinkSampler request RTM_GETLINK failed");
+                }
+
+                LinkStats stats{};
+                if (!parser_.parse_link(msg, nh.nlmsg_len, stats)) {
+                    THROW_MSG(std::runtime_error,
+                              "NetlinkSampler reply carries no link stats");
+                }
+                return stats;
+            }
+
+            offset += nl_align(nh.nlmsg_len);
+        }
+    }
+}
+
+void NetlinkSampler::receive_dump(bool only_requested) {
+    // A dump arrives as a series of multipart messages, terminated by
+    // NLMSG_DONE.
+    while (true) {
+        auto nread = recv(fd_, buffer_.data(), buffer_.size(), 0);
+        if (nread < 0) {
+            THROW_CERROR(std::runtime_error, "NetlinkSampler failed in recv()");
+        }
+
+        auto len = SIZE_T(nread);
+        std::size_t offset = 0;
+
+        while (offset + sizeof(nlmsghdr) <= len) {
+            const char *msg = buffer_.data() + offset;
+
+            nlmsghdr nh{};
+            memcpy(&nh, msg, sizeof(nh));
+
+            if ((nh.nlmsg_len < sizeof(nh)) || (offset + nh.nlmsg_len > len)) {
+                THROW_MSG(std::runtime_error,
+                          "NetlinkSampler received a truncated message");
+            }
+
+            offset += nl_align(nh.nlmsg_len);
+
+            // Skip replies to earlier requests that we gave up on
+            if (nh.nlmsg_seq != seq_) {
+                continue;
+            }
+
+            if (nh.nlmsg_type == NLMSG_DONE) {
+                return;
+            }
+
+            if (nh.nlmsg_type == NLMSG_ERROR) {
+                nlmsgerr err{};
+                memcpy(&err, msg + nl_align(sizeof(nh)), sizeof(err));
+
+                errno = -err.error;
+                THROW_CERROR(std::runtime_error,
+                             "NetlinkSampler dump RTM_GETLINK failed");
+            }
+
+            if (only_requested) {
+                ifinfomsg ifi{};
+                if (nh.nlmsg_len < nl_align(sizeof(nh)) + sizeof(ifi)) {
+                    continue;
+                }
+                memcpy(&ifi, msg + nl_align(sizeof(nh)), sizeof(ifi));
+
+                if ((ifi.ifi_index < 0) ||
+                    (SIZE_T(ifi.ifi_index) >= requested_.size()) ||
+                    !requested_[SIZE_T(ifi.ifi_index)]) {
+                    continue;
+                }
+            }
+
+            LinkStats stats{};
+            if (!parser_.parse_link(msg, nh.nlmsg_len, stats) ||
+                (stats.ifindex < 0)) {
+                continue;
+            }
+
+            auto index = SIZE_T(stats.ifindex);
+            if (index >= links_.size()) {
+                links_.resize(index + 1, LinkEntry{});
+            }
+
+            links_[index] = LinkEntry{stats, generation_};
+        }
+    }
+}
+
+void NetlinkSampler::dump_links(bool only_requested) {
+    ++generation_;
+    send_getlink_dump();
+    receive_dump(only_requested);
+}
+
+const NetlinkSampler::LinkEntry *
+NetlinkSampler::find_link(const std::string &iface_name) const {
+    auto it = ifindexes_.find(iface_name);
+    if (it == ifindexes_.end()) {
+        return nullptr;
+    }
+
+    auto index = SIZE_T(it->second);
+    if (index >= links_.size()) {
+        return nullptr;
+    }
+
+    // The interface must have been in the latest dump and still have the same
+    // name, otherwise it went away or was renamed.
+    const auto &entry = links_[index];
+    if ((entry.generation != generation_) ||
+        (iface_name != entry.stats.name.data())) {
+        return nullptr;
+    }
+
+    return &entry;
+}
+
+void NetlinkSampler::reindex_links(
+    const std::vector<std::string> &iface_names) {
+    ifindexes_.clear();
+
+    for (const auto &entry : links_) {
+        if (entry.generation == generation_) {
+            ifindexes_[entry.stats.name.data()] = entry.stats.ifindex;
+        }
+    }
+
+    requested_.assign(links_.size(), false);
+
+    for (const auto &iface_name : iface_names) {
+        auto it = ifindexes_.find(iface_name);
+        if (it != ifindexes_.end()) {
+            requested_[SIZE_T(it->second)] = true;
+        }
+    }
+}
+
+Sample NetlinkSampler::get_sample(const std::string &iface_name) {
+    TimePoint ts = Clock::now();
+
+    send_getlink(iface_name);
+    auto stats = receive_link();
+
+    Sample sample{
+        stats.rx,
+        stats.tx,
+        ts,
+    };
+
+    return sample;
+}
+
+void NetlinkSampler::get_samples(const std::vector<std::string> &iface_names,
+                                 std::vector<Sample> &samples) {
+    samples.clear();
+
+    if (iface_names.size() <= max_targeted_links) {
+        for (const auto &iface_name : iface_names) {
+            samples.push_back(get_sample(iface_name));
+        }
+        return;
+    }
+
+    TimePoint ts = Clock::now();
+
+    dump_links(true);
+
+    bool reindexed = false;
+
+    for (const auto &iface_name : iface_names) {
+        const LinkEntry *entry = find_link(iface_name);
+
+        // The name -> ifindex mapping only needs rebuilding when interfaces
+        // have been added, removed or renamed. That takes a dump with every
+        // interface decoded.
+        if ((entry == nullptr) && !reindexed) {
+            dump_links(false);
+            reindex_links(iface_names);
+            reindexed = true;
+            entry = find_link(iface_name);
+        }
+
+        if (entry == nullptr) {
+            THROW_ARGS(std::runtime_error, "failed to find iface: %s",
+                       iface_name.c_str());
+        }
+
+        samples.push_back(Sample{entry->stats.rx, entry->stats.tx, ts});
+    }
+}
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // __linux__
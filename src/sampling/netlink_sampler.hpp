@@ -0,0 +1,92 @@
+#ifndef NETLINK_SAMPLER_H
+#define NETLINK_SAMPLER_H
+
+// rtnetlink only exists on Linux
+#ifdef __linux__
+
+#include <array>
+#include <net/if.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sampling/sampler.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+struct LinkStats {
+    int ifindex;
+    std::array<char, IFNAMSIZ> name;
+    uint64_t rx;
+    uint64_t tx;
+};
+
+class NetlinkParser {
+  public:
+    // Parses one RTM_NEWLINK message (starting at the nlmsghdr). Returns false
+    // if the message carries no stats.
+    bool parse_link(const char *msg, std::size_t len, LinkStats &stats) const;
+};
+
+// Asks the kernel for the interface counters over a NETLINK_ROUTE socket
+// that stays open for the lifetime of the sampler. rx and tx come out of the
+// same rtnl_link_stats64 snapshot.
+//
+// A few interfaces are asked for one by one. When sampling many we ask for a
+// dump of all of them instead and store the result in a flat table indexed by
+// ifindex, so the cost per tick is one request and a single pass over every
+// interface on the system. Only the attributes of the interfaces we sample are
+// decoded, unless one of them can't be found.
+class NetlinkSampler : public Sampler {
+  public:
+    NetlinkSampler();
+    ~NetlinkSampler() override;
+
+    CLASS_DISABLE_COPIES(NetlinkSampler)
+    CLASS_DISABLE_MOVES(NetlinkSampler)
+
+    Sample get_sample(const std::string &iface_name) override;
+    void get_samples(const std::vector<std::string> &iface_names,
+                     std::vector<Sample> &samples) override;
+
+  private:
+    struct LinkEntry {
+        LinkStats stats;
+        // which dump this entry was last seen in
+        uint64_t generation;
+    };
+
+    void send_getlink(const std::string &iface_name);
+    void send_getlink_dump();
+    void send_request(const char *req, std::size_t len);
+    LinkStats receive_link();
+    void receive_dump(bool only_requested);
+    void dump_links(bool only_requested);
+    const LinkEntry *find_link(const std::string &iface_name) const;
+    void reindex_links(const std::vector<std::string> &iface_names);
+
+    int fd_{-1};
+    uint32_t seq_{0};
+
+    NetlinkParser parser_{};
+
+    // big enough for the largest chunk of a dump the kernel will send us
+    std::vector<char> buffer_ = std::vector<char>(65536);
+
+    // indexed by ifindex
+    std::vector<LinkEntry> links_{};
+    uint64_t generation_{0};
+
+    // iface name -> ifindex, rebuilt when interfaces come and go
+    std::unordered_map<std::string, int> ifindexes_{};
+    // indexed by ifindex, whether we sample that interface
+    std::vector<bool> requested_{};
+};
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // __linux__
+
+#endif // NETLINK_SAMPLER_H
@@ -39,9 +39,8 @@ NetstatStatsParser::parse(const std::vector<std::string> &lines,
               "failed to find the right iface / parse output");
 }
 
-Sample NetstatCommandSampler::get_sample(const std::string &iface_name) const {
-    auto tp = Clock::now();
-    std::time_t ts = Clock::to_time_t(tp);
+Sample NetstatCommandSampler::get_sample(const std::string &iface_name) {
+    TimePoint ts = Clock::now();
 
     std::string args{"netstat -ibn"};
 
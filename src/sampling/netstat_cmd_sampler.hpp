@@ -29,7 +29,7 @@ class NetstatCommandSampler : public Sampler {
     CLASS_DISABLE_COPIES(NetstatCommandSampler)
     CLASS_DISABLE_MOVES(NetstatCommandSampler)
 
-    Sample get_sample(const std::string &iface_name) const override;
+    Sample get_sample(const std::string &iface_name) override;
 
   private:
     ProgramRunner runner_{};
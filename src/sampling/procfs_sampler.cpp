@@ -1,5 +1,7 @@
-#include <fstream>
+#include <charconv>
+#include <fcntl.h>
 #include <stdexcept>
+#include <unordered_map>
 
 #include "aliases.hpp"
 #include "except.hpp"
@@ -8,54 +10,186 @@
 namespace bandwit {
 namespace sampling {
 
-std::vector<std::string> ProcFsParser::read_file_as_lines() const {
-    std::ifstream fl{filepath_};
-    if (!fl) {
-        THROW_ARGS(std::runtime_error, "failed to open file for reading: %s",
-                   filepath_.c_str());
+ProcFsParser::ProcFsParser(std::string filepath)
+    : filepath_{std::move(filepath)} {}
+
+ProcFsParser::~ProcFsParser() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+std::string_view ProcFsParser::read_file() {
+    // The file is opened once and then re-read from the start on every call,
+    // which makes the kernel regenerate the contents.
+    if (fd_ < 0) {
+        fd_ = open(filepath_.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            THROW_ARGS(std::runtime_error,
+                       "failed to open file for reading: %s",
+                       filepath_.c_str());
+        }
+    }
+
+    std::size_t total = 0;
+
+    while (true) {
+        if (total == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+
+        auto nread = pread(fd_, buffer_.data() + total, buffer_.size() - total,
+                           static_cast<off_t>(total));
+        if (nread < 0) {
+            THROW_CERROR(std::runtime_error, "failed to read /proc/net/dev");
+        }
+        if (nread == 0) {
+            break;
+        }
+
+        total += SIZE_T(nread);
+    }
+
+    return std::string_view{buffer_.data(), total};
+}
+
+bool ProcFsParser::split_line(std::string_view line,
+                              std::string_view &iface_name,
+                              std::string_view &counters) {
+    // A line looks like this, where the first number is rx bytes and the ninth
+    // is tx bytes:
+    //   eth0: 1116  12 0 0 0 0 0 0  1254  13 0 0 0 0 0 0
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos) {
+        // one of the header lines
+        return false;
     }
 
-    std::string line{};
-    std::vector<std::string> lines{};
+    auto name_start = line.find_first_not_of(' ');
+    if (name_start >= colon) {
+        return false;
+    }
+    iface_name = line.substr(name_start, colon - name_start);
+    counters = line.substr(colon + 1);
+
+    return true;
+}
+
+bool ProcFsParser::parse_counters(std::string_view counters, uint64_t &rx,
+                                  uint64_t &tx) {
+    const char *cur = counters.data();
+    const char *end = counters.data() + counters.size();
 
-    while (getline(fl, line)) {
-        lines.push_back(std::move(line));
+    for (int field = 0; field < 9; ++field) {
+        while ((cur < end) && (*cur == ' ')) {
+            ++cur;
+        }
+
+        uint64_t value = 0;
+        auto res = std::from_chars(cur, end, value);
+        if (res.ec != std::errc()) {
+            return false;
+        }
+        cur = res.ptr;
+
+        if (field == 0) {
+            rx = value;
+        } else if (field == 8) {
+            tx = value;
+        }
     }
 
-    return lines;
+    return true;
 }
 
 std::pair<uint64_t, uint64_t>
-ProcFsParser::parse(const std::vector<std::string> &lines,
+ProcFsParser::parse(std::string_view contents,
                     const std::string &iface_name) const {
-    for (const std::string &line : lines) {
-        std::smatch mres;
-
-        bool matches = std::regex_search(line, mres, pat_line_);
-        if (matches) {
-            std::string cur_iface = mres[1];
-            if (cur_iface == iface_name) {
-                std::string rx_s = mres[2];
-                std::string tx_s = mres[10];
+    std::size_t pos = 0;
 
-                uint64_t rx = std::stoul(rx_s);
-                uint64_t tx = std::stoul(tx_s);
+    while (pos < contents.size()) {
+        auto eol = contents.find('\n', pos);
+        if (eol == std::string_view::npos) {
+            eol = contents.size();
+        }
 
-                return std::make_pair(rx, tx);
-            }
+        // only the counters of the interface we're after are parsed
+        std::string_view name{};
+        std::string_view counters{};
+        uint64_t rx = 0;
+        uint64_t tx = 0;
+        if (split_line(contents.substr(pos, eol - pos), name, counters) &&
+            (name == iface_name) && parse_counters(counters, rx, tx)) {
+            return std::make_pair(rx, tx);
         }
+
+        pos = eol + 1;
     }
 
     THROW_MSG(std::runtime_error,
               "failed to find the right iface / parse output");
 }
 
-Sample ProcFsSampler::get_sample(const std::string &iface_name) const {
-    auto tp = Clock::now();
-    std::time_t ts = Clock::to_time_t(tp);
+void ProcFsParser::parse_all(
+    std::string_view contents, const std::vector<std::string> &iface_names,
+    std::vector<std::pair<uint64_t, uint64_t>> &counters) {
+    if (iface_names != slot_names_) {
+        index_slots(iface_names);
+    }
+
+    counters.resize(iface_names.size());
+    found_.assign(iface_names.size(), false);
+
+    std::size_t pos = 0;
+
+    while (pos < contents.size()) {
+        auto eol = contents.find('\n', pos);
+        if (eol == std::string_view::npos) {
+            eol = contents.size();
+        }
+
+        std::string_view name{};
+        std::string_view line_counters{};
+        if (split_line(contents.substr(pos, eol - pos), name,
+                       line_counters)) {
+            auto it = slots_.find(name);
+            uint64_t rx = 0;
+            uint64_t tx = 0;
+            if ((it != slots_.end()) &&
+                parse_counters(line_counters, rx, tx)) {
+                counters[it->second] = std::make_pair(rx, tx);
+                found_[it->second] = true;
+            }
+        }
 
-    auto lines = parser_.read_file_as_lines();
-    auto pair = parser_.parse(lines, iface_name);
+        pos = eol + 1;
+    }
+
+    for (std::size_t i = 0; i < iface_names.size(); ++i) {
+        auto first = slots_.at(iface_names[i]);
+        if (!found_[first]) {
+            THROW_ARGS(std::runtime_error, "failed to find iface: %s",
+                       iface_names[i].c_str());
+        }
+        counters[i] = counters[first];
+    }
+}
+
+void ProcFsParser::index_slots(const std::vector<std::string> &iface_names) {
+    // the keys are views of our own copy of the names
+    slots_.clear();
+    slot_names_ = iface_names;
+
+    for (std::size_t i = 0; i < slot_names_.size(); ++i) {
+        slots_.emplace(slot_names_[i], i);
+    }
+}
+
+Sample ProcFsSampler::get_sample(const std::string &iface_name) {
+    TimePoint ts = Clock::now();
+
+    auto contents = parser_.read_file();
+    auto pair = parser_.parse(contents, iface_name);
 
     Sample sample{
         pair.first,
@@ -66,5 +200,20 @@ Sample ProcFsSampler::get_sample(const std::string &iface_name) const {
     return sample;
 }
 
+void ProcFsSampler::get_samples(const std::vector<std::string> &iface_names,
+                                std::vector<Sample> &samples) {
+    TimePoint ts = Clock::now();
+
+    // one read of the file covers every interface
+    auto contents = parser_.read_file();
+    parser_.parse_all(contents, iface_names, counters_);
+
+    samples.clear();
+
+    for (const auto &pair : counters_) {
+        samples.push_back(Sample{pair.first, pair.second, ts});
+    }
+}
+
 } // namespace sampling
 } // namespace bandwit
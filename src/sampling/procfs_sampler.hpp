@@ -1,8 +1,9 @@
 #ifndef PROCFS_SAMPLER_H
 #define PROCFS_SAMPLER_H
 
-#include <regex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "sampling/sampler.hpp"
@@ -10,16 +11,46 @@
 namespace bandwit {
 namespace sampling {
 
+// Parses /proc/net/dev in a single pass over a buffer that is reused between
+// reads, without allocating per line or per field.
 class ProcFsParser {
   public:
-    std::vector<std::string> read_file_as_lines() const;
-    std::pair<uint64_t, uint64_t> parse(const std::vector<std::string> &lines,
+    explicit ProcFsParser(std::string filepath);
+    ~ProcFsParser();
+
+    CLASS_DISABLE_COPIES(ProcFsParser)
+    CLASS_DISABLE_MOVES(ProcFsParser)
+
+    std::string_view read_file();
+    std::pair<uint64_t, uint64_t> parse(std::string_view contents,
                                         const std::string &iface_name) const;
+    // fills `counters` with the counters of every interface, in the same
+    // order as the names
+    void parse_all(std::string_view contents,
+                   const std::vector<std::string> &iface_names,
+                   std::vector<std::pair<uint64_t, uint64_t>> &counters);
 
   private:
-    std::string filepath_{"/proc/net/dev"};
-    std::regex pat_line_{
-        R"(^\s*([A-Za-z0-9]+):\s+([0-9]+)\s+([0-9]+)\s+([0-9]+)\s+([0-9]+)\s+([0-9]+)\s+([0-9]+)\s+([0-9]+)\s+([0-9]+)\s+([0-9]+))"};
+    // Lines are split first, so the counters are only parsed for the
+    // interfaces we're after.
+    static bool split_line(std::string_view line, std::string_view &iface_name,
+                           std::string_view &counters);
+    static bool parse_counters(std::string_view counters, uint64_t &rx,
+                               uint64_t &tx);
+    void index_slots(const std::vector<std::string> &iface_names);
+
+    std::string filepath_{};
+    int fd_{-1};
+
+    // grows to fit the file and then stays at that size
+    std::vector<char> buffer_ = std::vector<char>(16384);
+
+    // The names parse_all was asked for last, and where each of them goes in
+    // the result (the first occurrence if a name is requested more than
+    // once). They're only indexed again when the names change.
+    std::vector<std::string> slot_names_{};
+    std::unordered_map<std::string_view, std::size_t> slots_{};
+    std::vector<bool> found_{};
 };
 
 class ProcFsSampler : public Sampler {
@@ -30,13 +61,17 @@ class ProcFsSampler : public Sampler {
     CLASS_DISABLE_COPIES(ProcFsSampler)
     CLASS_DISABLE_MOVES(ProcFsSampler)
 
-    Sample get_sample(const std::string &iface_name) const override;
+    Sample get_sample(const std::string &iface_name) override;
+    void get_samples(const std::vector<std::string> &iface_names,
+                     std::vector<Sample> &samples) override;
 
   private:
-    ProcFsParser parser_{};
+    ProcFsParser parser_{"/proc/net/dev"};
+    // reused between ticks
+    std::vector<std::pair<uint64_t, uint64_t>> counters_{};
 };
 
 } // namespace sampling
 } // namespace bandwit
 
-#endif // PROCFS_SAMPLER_H
\ No newline at end of file
+#endif // PROCFS_SAMPLER_H
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+
+#include "macros.hpp"
+#include "quantile_sketch.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+static const double relative_accuracy = 0.05;
+static const double gamma =
+    (1.0 + relative_accuracy) / (1.0 - relative_accuracy);
+static const double log_gamma = std::log(gamma);
+static const std::size_t max_bins = 64;
+
+void QuantileSketch::add(uint64_t value, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    if (count_ == 0) {
+        min_ = value;
+        max_ = value;
+    } else {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    count_ += count;
+
+    if (value == 0) {
+        zero_count_ += count;
+    } else {
+        add_to_bin(get_index(value), count);
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch &other) {
+    if (other.count_ == 0) {
+        return;
+    }
+
+    if (count_ == 0) {
+        min_ = other.min_;
+        max_ = other.max_;
+    } else {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    count_ += other.count_;
+    zero_count_ += other.zero_count_;
+
+    for (const auto &bin : other.bins_) {
+        add_to_bin(bin.index, bin.count);
+    }
+}
+
+void QuantileSketch::clear() {
+    count_ = 0;
+    zero_count_ = 0;
+    min_ = 0;
+    max_ = 0;
+    bins_.clear();
+}
+
+bool QuantileSketch::empty() const { return count_ == 0; }
+
+uint64_t QuantileSketch::count() const { return count_; }
+
+uint64_t QuantileSketch::min() const { return min_; }
+
+uint64_t QuantileSketch::max() const { return max_; }
+
+uint64_t QuantileSketch::quantile(double q) const {
+    if (count_ == 0) {
+        return 0;
+    }
+
+    // the sample that has this many samples before it
+    auto rank = q * F64(count_ - 1);
+
+    auto seen = zero_count_;
+    if (F64(seen) > rank) {
+        return 0;
+    }
+
+    for (const auto &bin : bins_) {
+        seen += bin.count;
+        if (F64(seen) > rank) {
+            // the bounds of a bin are only approximate for the outer samples
+            auto value = U64(std::llround(get_value(bin.index)));
+            return std::min(std::max(value, min_), max_);
+        }
+    }
+
+    return max_;
+}
+
+std::size_t QuantileSketch::memory_usage() const {
+    return sizeof(QuantileSketch) + bins_.capacity() * sizeof(Bin);
+}
+
+std::size_t QuantileSketch::max_memory_usage() {
+    return sizeof(QuantileSketch) + max_bins * sizeof(Bin);
+}
+
+int32_t QuantileSketch::get_index(uint64_t value) {
+    // the bin covers the values in (gamma^(index - 1), gamma^index]
+    return static_cast<int32_t>(std::ceil(std::log(F64(value)) / log_gamma));
+}
+
+double QuantileSketch::get_value(int32_t index) {
+    // the value that is equally far off from both bounds, relatively
+    return 2.0 * std::pow(gamma, index) / (gamma + 1.0);
+}
+
+void QuantileSketch::add_to_bin(int32_t index, uint32_t count) {
+    auto it = std::lower_bound(
+        bins_.begin(), bins_.end(), index,
+        [](const Bin &bin, int32_t idx) { return bin.index < idx; });
+
+    if ((it != bins_.end()) && (it->index == index)) {
+        it->count += count;
+        return;
+    }
+
+    // Merge the lowest bins, so that the high quantiles stay accurate. This
+    // is done before inserting, so the bins never grow past `max_bins`.
+    if (bins_.size() == max_bins) {
+        auto pos = it - bins_.begin();
+        if (pos == 0) {
+            bins_[0].count += count;
+            return;
+        }
+        if (pos == 1) {
+            bins_[0] = Bin{index, bins_[0].count + count};
+            return;
+        }
+        bins_[1].count += bins_[0].count;
+        it = bins_.erase(bins_.begin()) + (pos - 1);
+    }
+
+    bins_.insert(it, Bin{index, count});
+}
+
+} // namespace sampling
+} // namespace bandwit
@@ -0,0 +1,60 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <cstdint>
+#include <vector>
+
+namespace bandwit {
+namespace sampling {
+
+// A summary of the distribution of the samples in a bucket, from which
+// quantiles can be estimated. The sketches of adjacent buckets merge into the
+// sketch of the bucket that contains them.
+//
+// Samples are counted in bins whose bounds grow by a factor of (1 + a) / (1 -
+// a), with a = 5%. A quantile is reported as the middle of its bin, which is
+// within 5% of the sample of that rank. There are at most 64 bins, which
+// covers a range of about 600x. Should the samples spread out further the
+// lowest bins are merged, so only quantiles below 1/600 of the max lose
+// accuracy. The min and the max are exact.
+class QuantileSketch {
+  public:
+    void add(uint64_t value, uint32_t count);
+    void merge(const QuantileSketch &other);
+    void clear();
+
+    bool empty() const;
+    uint64_t count() const;
+    uint64_t min() const;
+    uint64_t max() const;
+    // `q` is between 0 and 1
+    uint64_t quantile(double q) const;
+
+    std::size_t memory_usage() const;
+    // the most a sketch ever takes, once all of its bins are in use
+    static std::size_t max_memory_usage();
+
+  private:
+    struct Bin {
+        int32_t index;
+        uint32_t count;
+    };
+
+    static int32_t get_index(uint64_t value);
+    static double get_value(int32_t index);
+
+    void add_to_bin(int32_t index, uint32_t count);
+
+    uint64_t count_{0};
+    uint64_t zero_count_{0};
+    uint64_t min_{0};
+    uint64_t max_{0};
+
+    // ordered by index
+    std::vector<Bin> bins_{};
+};
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // QUANTILE_SKETCH_H
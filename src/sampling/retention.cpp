@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "macros.hpp"
+#include "quantile_sketch.hpp"
+#include "retention.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+std::vector<Retention>
+RetentionPlanner::plan(const std::vector<AggregationWindow> &windows,
+                       std::size_t num_copies) const {
+    std::vector<Retention> retentions{};
+
+    for (auto window : windows) {
+        auto capacity = round_up_pow2(requested_capacity(window));
+        // the finest window has a single sample per bucket, which doesn't
+        // need a sketch
+        auto sketch_slots =
+            retentions.empty() ? 0 : std::min(capacity, max_sketch_slots);
+        retentions.push_back(Retention{window, capacity, sketch_slots});
+    }
+
+    if (!memory_budget_.has_value() || retentions.empty()) {
+        return retentions;
+    }
+
+    // Split the budget evenly, starting with the smallest series. A series
+    // that needs less than its share leaves the rest to the bigger ones.
+    std::vector<Retention *> by_size{};
+    for (auto &retention : retentions) {
+        by_size.push_back(&retention);
+    }
+    std::stable_sort(by_size.begin(), by_size.end(),
+                     [](const Retention *lhs, const Retention *rhs) {
+                         return lhs->capacity < rhs->capacity;
+                     });
+
+    auto budget = memory_budget_.value();
+    auto num_left = U64(by_size.size() * num_copies);
+
+    for (auto *retention : by_size) {
+        auto share = budget / num_left * num_copies;
+
+        // Halve whichever of the points and the sketches takes more, so a
+        // small budget doesn't go entirely to one of them.
+        while (series_bytes(*retention, num_copies) +
+                   sketch_bytes(*retention, num_copies) >
+               share) {
+            if ((retention->sketch_slots > 0) &&
+                (sketch_bytes(*retention, num_copies) >=
+                 series_bytes(*retention, num_copies))) {
+                retention->sketch_slots /= 2;
+            } else if (retention->capacity > 1) {
+                retention->capacity /= 2;
+                retention->sketch_slots =
+                    std::min(retention->sketch_slots, retention->capacity);
+            } else {
+                break;
+            }
+        }
+
+        auto used = series_bytes(*retention, num_copies) +
+                    sketch_bytes(*retention, num_copies);
+        budget = used < budget ? budget - used : 0;
+        num_left -= num_copies;
+    }
+
+    return retentions;
+}
+
+std::string
+RetentionPlanner::format_report(const std::vector<Retention> &retentions,
+                                std::size_t num_copies) const {
+    std::stringstream ss{};
+    ss << std::left << std::setw(8) << "window" << std::right << std::setw(10)
+       << "points" << std::setw(14) << "span" << std::setw(12) << "memory"
+       << std::setw(10) << "sketches" << std::setw(12) << "memory"
+       << "\n";
+
+    uint64_t total = 0;
+
+    for (const auto &retention : retentions) {
+        auto span = get_interval(retention.window) * retention.capacity;
+        auto bytes = U64(retention.capacity * bytes_per_point());
+        auto sketches = sketch_bytes(retention, num_copies);
+        total += series_bytes(retention, num_copies) + sketches;
+
+        ss << std::left << std::setw(8) << get_label(retention.window)
+           << std::right << std::setw(10) << retention.capacity
+           << std::setw(14) << format_span(span) << std::setw(12)
+           << format_bytes(bytes) << std::setw(10) << retention.sketch_slots
+           << std::setw(12) << format_bytes(sketches) << "\n";
+    }
+
+    ss << "\n"
+       << num_copies << " series per window, " << format_bytes(total)
+       << " in total";
+    if (memory_budget_.has_value()) {
+        ss << " (budget " << format_bytes(memory_budget_.value()) << ")";
+    }
+    ss << "\n";
+
+    return ss.str();
+}
+
+std::size_t RetentionPlanner::bytes_per_point() { return sizeof(uint64_t); }
+
+std::size_t RetentionPlanner::bytes_per_sketch_slot(std::size_t num_copies) {
+    // a sketch for every series, plus the key of the bucket and whether the
+    // slot is in use
+    return num_copies * QuantileSketch::max_memory_usage() +
+           2 * sizeof(uint64_t);
+}
+
+uint64_t RetentionPlanner::series_bytes(const Retention &retention,
+                                        std::size_t num_copies) {
+    return U64(retention.capacity * bytes_per_point() * num_copies);
+}
+
+uint64_t RetentionPlanner::sketch_bytes(const Retention &retention,
+                                        std::size_t num_copies) {
+    return U64(retention.sketch_slots * bytes_per_sketch_slot(num_copies));
+}
+
+std::size_t
+RetentionPlanner::requested_capacity(AggregationWindow window) const {
+    auto it = durations_.find(window);
+    if (it == durations_.end()) {
+        return default_capacity_;
+    }
+
+    // enough points to cover the whole duration
+    auto interval = get_interval(window);
+    // rounded up, without adding to the duration, which may be close to the
+    // largest we can parse
+    auto num_points = it->second / interval;
+    if (it->second % interval != Millis{0}) {
+        ++num_points;
+    }
+    return std::max(SIZE_T(num_points), SIZE_T(1));
+}
+
+std::size_t RetentionPlanner::round_up_pow2(std::size_t num) {
+    std::size_t pow2 = 1;
+    while (pow2 < num) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+std::size_t RetentionPlanner::round_down_pow2(std::size_t num) {
+    std::size_t pow2 = 1;
+    while (pow2 <= num / 2) {
+        pow2 <<= 1;
+    }
+    return pow2;
+}
+
+std::string RetentionPlanner::format_bytes(uint64_t num) {
+    std::stringstream ss{};
+    ss << std::fixed << std::setprecision(1);
+
+    if (num >= (U64(1) << 30)) {
+        ss << F64(num) / F64(U64(1) << 30) << " GiB";
+    } else if (num >= (U64(1) << 20)) {
+        ss << F64(num) / F64(U64(1) << 20) << " MiB";
+    } else if (num >= (U64(1) << 10)) {
+        ss << F64(num) / F64(U64(1) << 10) << " KiB";
+    } else {
+        ss << num << " B";
+    }
+
+    return ss.str();
+}
+
+std::string RetentionPlanner::format_span(Millis span) {
+    // the two most significant units, eg. 2h16m or 90d0h
+    auto total_secs = U64(span.count() / 1000);
+    auto days = total_secs / 86400;
+    auto hours = (total_secs % 86400) / 3600;
+    auto mins = (total_secs % 3600) / 60;
+    auto secs = total_secs % 60;
+
+    std::stringstream ss{};
+    if (days > 0) {
+        ss << days << "d" << hours << "h";
+    } else if (hours > 0) {
+        ss << hours << "h" << mins << "m";
+    } else if (mins > 0) {
+        ss << mins << "m" << secs << "s";
+    } else if (secs > 0) {
+        ss << secs << "s";
+    } else {
+        ss << span.count() << "ms";
+    }
+
+    return ss.str();
+}
+
+} // namespace sampling
+} // namespace bandwit
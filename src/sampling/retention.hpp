@@ -0,0 +1,74 @@
+#ifndef RETENTION_H
+#define RETENTION_H
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "aliases.hpp"
+#include "sampling/agg_window.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+// How many points to keep of the time series for a window
+struct Retention {
+    AggregationWindow window;
+    std::size_t capacity;
+    // how many of the most recent buckets keep their quantile sketches
+    std::size_t sketch_slots{0};
+};
+
+// Works out how many points each time series keeps: by default
+// `default_capacity_`, or enough to cover the requested duration. The
+// capacity is rounded up to a power of two. When a memory budget is given the
+// series are scaled down to fit in it.
+//
+// Every window but the finest also keeps the quantile sketches of its most
+// recent buckets (up to `max_sketch_slots`), which is charged to the budget
+// as well.
+class RetentionPlanner {
+  public:
+    RetentionPlanner(std::map<AggregationWindow, Millis> durations,
+                     std::optional<uint64_t> memory_budget)
+        : durations_{std::move(durations)}, memory_budget_{memory_budget} {}
+
+    // `num_copies` is how many series there are for every window (rx and tx
+    // for every interface)
+    std::vector<Retention> plan(const std::vector<AggregationWindow> &windows,
+                                std::size_t num_copies) const;
+
+    std::string format_report(const std::vector<Retention> &retentions,
+                              std::size_t num_copies) const;
+
+    static std::size_t bytes_per_point();
+    static std::size_t bytes_per_sketch_slot(std::size_t num_copies);
+
+    // At the minute level that's close to three days.
+    static constexpr std::size_t max_sketch_slots = 4096;
+
+  private:
+    std::size_t requested_capacity(AggregationWindow window) const;
+    static uint64_t series_bytes(const Retention &retention,
+                                 std::size_t num_copies);
+    static uint64_t sketch_bytes(const Retention &retention,
+                                 std::size_t num_copies);
+
+    static std::size_t round_up_pow2(std::size_t num);
+    static std::size_t round_down_pow2(std::size_t num);
+
+    static std::string format_bytes(uint64_t num);
+    static std::string format_span(Millis span);
+
+    std::map<AggregationWindow, Millis> durations_{};
+    std::optional<uint64_t> memory_budget_{};
+
+    std::size_t default_capacity_{512};
+};
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // RETENTION_H
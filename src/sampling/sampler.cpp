@@ -0,0 +1,16 @@
+#include "sampling/sampler.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+void Sampler::get_samples(const std::vector<std::string> &iface_names,
+                          std::vector<Sample> &samples) {
+    samples.clear();
+
+    for (const auto &iface_name : iface_names) {
+        samples.push_back(get_sample(iface_name));
+    }
+}
+
+} // namespace sampling
+} // namespace bandwit
@@ -6,6 +6,7 @@
 #include "except.hpp"
 #include "sampler_detector.hpp"
 #include "sampling/ip_cmd_sampler.hpp"
+#include "sampling/netlink_sampler.hpp"
 #include "sampling/netstat_cmd_sampler.hpp"
 #include "sampling/procfs_sampler.hpp"
 #include "sampling/sysfs_sampler.hpp"
@@ -22,6 +23,10 @@ SamplerDetector::detect_sampler(const std::string &iface_name) const {
     std::vector<Pair> samplers{};
     samplers.emplace_back(PAIR(SysFsSampler));
     samplers.emplace_back(PAIR(ProcFsSampler));
+#ifdef __linux__
+    // prefer asking the kernel directly over spawning processes
+    samplers.emplace_back(PAIR(NetlinkSampler));
+#endif
     samplers.emplace_back(PAIR(IpCommandSampler));
     samplers.emplace_back(PAIR(NetstatCommandSampler));
 
@@ -0,0 +1,129 @@
+#include <csignal>
+#include <pthread.h>
+#include <stdexcept>
+
+#include "except.hpp"
+#include "sampling_thread.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+SamplingThread::SamplingThread(std::unique_ptr<Sampler> sampler,
+                               std::string iface_name, Millis interval)
+    : sampler_{std::move(sampler)}, iface_names_{std::move(iface_name)},
+      scheduler_{interval} {}
+
+SamplingThread::~SamplingThread() { stop(); }
+
+void SamplingThread::start(tools::WakeupPipe *notifier) {
+    notifier_ = notifier;
+
+    // Signals have to be handled on the UI thread (the SIGINT handler unwinds
+    // the stack by throwing), so the sampling thread must not receive any.
+    // A new thread inherits the signal mask, so block everything while we
+    // create it.
+    sigset_t all{};
+    sigset_t prev{};
+    sigfillset(&all);
+
+    if (pthread_sigmask(SIG_BLOCK, &all, &prev) != 0) {
+        THROW_MSG(std::runtime_error,
+                  "SamplingThread.start failed in pthread_sigmask()");
+    }
+
+    thread_ = std::thread{&SamplingThread::run, this};
+
+    if (pthread_sigmask(SIG_SETMASK, &prev, nullptr) != 0) {
+        THROW_MSG(std::runtime_error,
+                  "SamplingThread.start failed in pthread_sigmask()");
+    }
+}
+
+void SamplingThread::stop() {
+    stop_flag_.request_stop();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool SamplingThread::pop(Sample &sample) {
+    if (ring_.try_pop(sample)) {
+        return true;
+    }
+
+    // only once the ring is drained, so that we don't lose the samples that
+    // were taken before the failure
+    if (failed_.load(std::memory_order_acquire)) {
+        std::rethrow_exception(exception_);
+    }
+
+    return false;
+}
+
+SamplingStats SamplingThread::get_stats() const {
+    SamplingStats stats{};
+
+    stats.num_ticks = num_ticks_.load(std::memory_order_relaxed);
+    stats.num_missed = num_missed_.load(std::memory_order_relaxed);
+    stats.num_dropped = num_dropped_.load(std::memory_order_relaxed);
+    stats.jitter_min =
+        tools::Nanos{jitter_min_.load(std::memory_order_relaxed)};
+    stats.jitter_mean =
+        tools::Nanos{jitter_mean_.load(std::memory_order_relaxed)};
+    stats.jitter_max =
+        tools::Nanos{jitter_max_.load(std::memory_order_relaxed)};
+
+    return stats;
+}
+
+void SamplingThread::run() {
+    try {
+        std::optional<tools::Tick> tick = scheduler_.start();
+
+        while (tick.has_value()) {
+            sampler_->get_samples(iface_names_, samples_);
+            Sample sample = samples_.front();
+
+            // Use the time the tick was scheduled for rather than the time we
+            // got around to sampling, so that every tick lands in its own
+            // bucket.
+            sample.ts = tick->tp;
+
+            // If the consumer has fallen this far behind we drop the sample.
+            // Since samples are counters the traffic is not lost, it is
+            // counted towards the next sample that makes it into the ring.
+            if (ring_.try_push(sample)) {
+                notifier_->notify();
+            } else {
+                num_dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            tick = scheduler_.wait_for_tick(stop_flag_);
+            publish_stats();
+        }
+
+    } catch (...) {
+        exception_ = std::current_exception();
+        failed_.store(true, std::memory_order_release);
+
+        // so that the consumer gets to see the exception
+        notifier_->notify();
+    }
+}
+
+void SamplingThread::publish_stats() {
+    const auto &stats = scheduler_.get_stats();
+    if (stats.num_ticks == 0) {
+        return;
+    }
+
+    num_ticks_.store(stats.num_ticks, std::memory_order_relaxed);
+    num_missed_.store(stats.num_missed, std::memory_order_relaxed);
+    jitter_min_.store(stats.jitter_min.count(), std::memory_order_relaxed);
+    jitter_mean_.store(stats.jitter_mean().count(), std::memory_order_relaxed);
+    jitter_max_.store(stats.jitter_max.count(), std::memory_order_relaxed);
+}
+
+} // namespace sampling
+} // namespace bandwit
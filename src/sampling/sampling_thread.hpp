@@ -0,0 +1,90 @@
+#ifndef SAMPLING_THREAD_H
+#define SAMPLING_THREAD_H
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sampling/sampler.hpp"
+#include "tools/spsc_ring.hpp"
+#include "tools/stop_flag.hpp"
+#include "tools/tick_scheduler.hpp"
+#include "tools/wakeup_pipe.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+struct SamplingStats {
+    uint64_t num_ticks{0};
+    uint64_t num_missed{0};
+    // samples that didn't fit in the ring because the consumer fell behind
+    uint64_t num_dropped{0};
+
+    tools::Nanos jitter_min{0};
+    tools::Nanos jitter_mean{0};
+    tools::Nanos jitter_max{0};
+};
+
+// Takes a sample on every tick on a thread of its own, so that a slow render
+// does not delay sampling. The samples are handed over to the consumer
+// through a ring that is drained with `pop`, and the consumer is woken up
+// through `notifier` whenever there is something to pop.
+class SamplingThread {
+  public:
+    SamplingThread(std::unique_ptr<Sampler> sampler, std::string iface_name,
+                   Millis interval);
+    ~SamplingThread();
+
+    CLASS_DISABLE_COPIES(SamplingThread)
+    CLASS_DISABLE_MOVES(SamplingThread)
+
+    // `notifier` has to outlive the thread
+    void start(tools::WakeupPipe *notifier);
+    void stop();
+
+    // Called by the consumer. Rethrows the exception that stopped the thread,
+    // if any.
+    bool pop(Sample &sample);
+
+    SamplingStats get_stats() const;
+
+  private:
+    void run();
+    void publish_stats();
+
+    std::unique_ptr<Sampler> sampler_{nullptr};
+
+    // Sampled together, with a single read for the samplers that can. For now
+    // that's just the one interface we show.
+    std::vector<std::string> iface_names_{};
+    // reused between ticks
+    std::vector<Sample> samples_{};
+
+    tools::TickScheduler scheduler_;
+    tools::SpscRing<Sample> ring_{1024};
+
+    tools::WakeupPipe *notifier_{nullptr};
+
+    std::thread thread_{};
+    tools::StopFlag stop_flag_{};
+
+    std::atomic<bool> failed_{false};
+    std::exception_ptr exception_{nullptr};
+
+    // copies of the scheduler stats that can be read from the consumer
+    std::atomic<uint64_t> num_ticks_{0};
+    std::atomic<uint64_t> num_missed_{0};
+    std::atomic<uint64_t> num_dropped_{0};
+    std::atomic<int64_t> jitter_min_{0};
+    std::atomic<int64_t> jitter_mean_{0};
+    std::atomic<int64_t> jitter_max_{0};
+};
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // SAMPLING_THREAD_H
@@ -0,0 +1,262 @@
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "except.hpp"
+#include "series_file.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+static const char series_file_magic[8] = {'B', 'W', 'S', 'E',
+                                          'R', 'I', 'E', 'S'};
+static const uint32_t series_file_version = 1;
+
+SeriesFile::SeriesFile(std::string filepath, Millis interval,
+                       std::size_t capacity)
+    : filepath_{std::move(filepath)}, interval_{interval},
+      capacity_{capacity} {
+    open_file();
+    recover();
+    compact();
+}
+
+SeriesFile::~SeriesFile() {
+    unmap_file();
+
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+std::size_t SeriesFile::size() const { return num_records_; }
+
+const SeriesFile::Record &SeriesFile::get(std::size_t index) const {
+    return records()[index];
+}
+
+void SeriesFile::append(TimePoint tp, uint64_t value) {
+    if (num_records_ == num_slots_) {
+        auto num_slots = num_slots_ + grow_by_;
+        auto len = sizeof(Header) + num_slots * sizeof(Record);
+
+        if (ftruncate(fd_, static_cast<off_t>(len)) < 0) {
+            THROW_CERROR(std::runtime_error,
+                         "SeriesFile.append failed in ftruncate()");
+        }
+        map_file(num_slots);
+    }
+
+    Record record{};
+    record.time_ms = MILLIS(tp.time_since_epoch()).count();
+    record.value = value;
+    record.checksum = calculate_checksum(record);
+
+    records()[num_records_] = record;
+    ++num_records_;
+    header_->num_records = num_records_;
+
+    compact();
+}
+
+void SeriesFile::update_last(uint64_t value) {
+    if (num_records_ == 0) {
+        THROW_MSG(std::runtime_error, "SeriesFile.update_last on empty file");
+    }
+
+    auto &record = records()[num_records_ - 1];
+    record.value = value;
+    record.checksum = calculate_checksum(record);
+}
+
+void SeriesFile::sync() {
+    if (msync(mapping_, mapping_len_, MS_ASYNC) < 0) {
+        THROW_CERROR(std::runtime_error, "SeriesFile.sync failed in msync()");
+    }
+}
+
+void SeriesFile::open_file() {
+    fd_ = open(filepath_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        THROW_ARGS(std::runtime_error, "failed to open file: %s",
+                   filepath_.c_str());
+    }
+
+    // Another session appending to the same file would interleave its
+    // records with ours, and compacting it would pull the file out from under
+    // the other's mapping.
+    if (flock(fd_, LOCK_EX | LOCK_NB) < 0) {
+        int flock_errno = errno;
+        close(fd_);
+        fd_ = -1;
+
+        if (flock_errno == EWOULDBLOCK) {
+            THROW_ARGS(std::runtime_error,
+                       "data dir in use by another bandwit: %s",
+                       filepath_.c_str());
+        }
+        errno = flock_errno;
+        THROW_CERROR(std::runtime_error, "SeriesFile.open failed in flock()");
+    }
+
+    struct stat st {};
+    if (fstat(fd_, &st) < 0) {
+        THROW_CERROR(std::runtime_error, "SeriesFile.open failed in fstat()");
+    }
+
+    auto file_len = SIZE_T(st.st_size);
+
+    if (file_len < sizeof(Header)) {
+        // a new file (or one that never got as far as its header)
+        auto len = sizeof(Header) + grow_by_ * sizeof(Record);
+        if (ftruncate(fd_, static_cast<off_t>(len)) < 0) {
+            THROW_CERROR(std::runtime_error,
+                         "SeriesFile.open failed in ftruncate()");
+        }
+        map_file(grow_by_);
+
+        memcpy(header_->magic, series_file_magic, sizeof(series_file_magic));
+        header_->version = series_file_version;
+        header_->record_size = U32(sizeof(Record));
+        header_->interval_ms = interval_.count();
+        header_->num_records = 0;
+        return;
+    }
+
+    map_file((file_len - sizeof(Header)) / sizeof(Record));
+
+    if ((memcmp(header_->magic, series_file_magic,
+                sizeof(series_file_magic)) != 0) ||
+        (header_->version != series_file_version) ||
+        (header_->record_size != sizeof(Record))) {
+        THROW_ARGS(std::runtime_error, "not a bandwit series file: %s",
+                   filepath_.c_str());
+    }
+
+    if (header_->interval_ms != interval_.count()) {
+        THROW_ARGS(std::runtime_error, "series file has the wrong interval: %s",
+                   filepath_.c_str());
+    }
+}
+
+void SeriesFile::map_file(std::size_t num_slots) {
+    unmap_file();
+
+    auto len = sizeof(Header) + num_slots * sizeof(Record);
+    void *mapping =
+        mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        THROW_CERROR(std::runtime_error,
+                     "SeriesFile.map_file failed in mmap()");
+    }
+
+    mapping_ = mapping;
+    mapping_len_ = len;
+    header_ = static_cast<Header *>(mapping_);
+    num_slots_ = num_slots;
+}
+
+void SeriesFile::unmap_file() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, mapping_len_);
+        mapping_ = nullptr;
+        mapping_len_ = 0;
+        header_ = nullptr;
+    }
+}
+
+void SeriesFile::recover() {
+    auto num = std::min(SIZE_T(header_->num_records), num_slots_);
+
+    // If we crashed while writing a record it fails its checksum. Walk back to
+    // the last good one.
+    while ((num > 0) && !is_valid(records()[num - 1])) {
+        --num;
+    }
+
+    // The header is updated after the record, so there may be a good record
+    // it doesn't count yet.
+    while ((num < num_slots_) && is_valid(records()[num])) {
+        // records only ever move forward in time
+        if ((num > 0) &&
+            (records()[num].time_ms <= records()[num - 1].time_ms)) {
+            break;
+        }
+        ++num;
+    }
+
+    // Clear the corrupt tail, so that it can't be mistaken for records later.
+    for (auto i = num; i < num_slots_; ++i) {
+        auto &record = records()[i];
+        if ((record.time_ms == 0) && (record.value == 0) &&
+            (record.checksum == 0)) {
+            break;
+        }
+        memset(&record, 0, sizeof(Record));
+    }
+
+    num_records_ = num;
+    header_->num_records = num_records_;
+}
+
+void SeriesFile::compact() {
+    // Trim the file back to the records we'd keep in memory anyway when it has
+    // grown well beyond that, so that it doesn't grow for as long as we run.
+    if (num_records_ <= capacity_ * 2) {
+        return;
+    }
+
+    auto first = num_records_ - capacity_;
+    memmove(records(), records() + first, capacity_ * sizeof(Record));
+
+    num_records_ = capacity_;
+    header_->num_records = num_records_;
+
+    // Clear the records that were moved, so that they can't be mistaken for
+    // records later. Only what is mapped now, any slots the file grows by
+    // below are zero already.
+    auto num_slots = capacity_ + grow_by_;
+    memset(records() + num_records_, 0,
+           (std::min(num_slots, num_slots_) - num_records_) * sizeof(Record));
+
+    auto len = sizeof(Header) + num_slots * sizeof(Record);
+    unmap_file();
+    if (ftruncate(fd_, static_cast<off_t>(len)) < 0) {
+        THROW_CERROR(std::runtime_error,
+                     "SeriesFile.compact failed in ftruncate()");
+    }
+    map_file(num_slots);
+}
+
+uint32_t SeriesFile::calculate_checksum(const Record &record) {
+    // FNV-1a over the time and the value. The offset basis is not zero, so a
+    // record that was never written doesn't pass.
+    uint32_t hash = 2166136261u;
+
+    uint8_t bytes[sizeof(record.time_ms) + sizeof(record.value)];
+    memcpy(bytes, &record.time_ms, sizeof(record.time_ms));
+    memcpy(bytes + sizeof(record.time_ms), &record.value, sizeof(record.value));
+
+    for (auto byte : bytes) {
+        hash ^= byte;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+bool SeriesFile::is_valid(const Record &record) {
+    return record.checksum == calculate_checksum(record);
+}
+
+SeriesFile::Record *SeriesFile::records() const {
+    return reinterpret_cast<Record *>(static_cast<char *>(mapping_) +
+                                      sizeof(Header));
+}
+
+} // namespace sampling
+} // namespace bandwit
@@ -0,0 +1,85 @@
+#ifndef SERIES_FILE_H
+#define SERIES_FILE_H
+
+#include <cstdint>
+#include <string>
+
+#include "aliases.hpp"
+#include "macros.hpp"
+
+namespace bandwit {
+namespace sampling {
+
+// A time series on disk: a fixed header followed by fixed width records, one
+// per bucket, oldest first. The file is memory mapped, so appending a record
+// or updating the last one is a store to memory, and the kernel writes it
+// back. The last record is the bucket that is still open, which is updated in
+// place until the next one is appended.
+class SeriesFile {
+  public:
+    struct Record {
+        // the start of the bucket in milliseconds since the epoch
+        int64_t time_ms;
+        uint64_t value;
+        uint32_t checksum;
+        uint32_t reserved;
+    };
+
+    // Opens or creates the file. Whenever it has more than twice `capacity`
+    // records, only the last `capacity` are kept.
+    SeriesFile(std::string filepath, Millis interval, std::size_t capacity);
+    ~SeriesFile();
+
+    CLASS_DISABLE_COPIES(SeriesFile)
+    CLASS_DISABLE_MOVES(SeriesFile)
+
+    std::size_t size() const;
+    const Record &get(std::size_t index) const;
+
+    void append(TimePoint tp, uint64_t value);
+    void update_last(uint64_t value);
+
+    // asks the kernel to start writing back, without waiting for it
+    void sync();
+
+  private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+        int64_t interval_ms;
+        // may lag behind the records actually in the file after a crash
+        uint64_t num_records;
+    };
+
+    void open_file();
+    void map_file(std::size_t num_slots);
+    void unmap_file();
+    void recover();
+    void compact();
+
+    static uint32_t calculate_checksum(const Record &record);
+    static bool is_valid(const Record &record);
+
+    Record *records() const;
+
+    std::string filepath_{};
+    Millis interval_{};
+    std::size_t capacity_{0};
+
+    int fd_{-1};
+    void *mapping_{nullptr};
+    std::size_t mapping_len_{0};
+
+    Header *header_{nullptr};
+    std::size_t num_slots_{0};
+    std::size_t num_records_{0};
+
+    // how many records to grow the file by when it's full
+    std::size_t grow_by_{4096};
+};
+
+} // namespace sampling
+} // namespace bandwit
+
+#endif // SERIES_FILE_H
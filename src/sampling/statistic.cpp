@@ -3,14 +3,47 @@
 namespace bandwit {
 namespace sampling {
 
+Statistic next_statistic(Statistic stat) {
+    switch (stat) {
+    case Statistic::AVERAGE:
+        return Statistic::SUM;
+    case Statistic::SUM:
+        return Statistic::MAX;
+    case Statistic::MAX:
+        return Statistic::MIN;
+    case Statistic::MIN:
+        return Statistic::P95;
+    case Statistic::P95:
+        return Statistic::P99;
+    case Statistic::P99:
+        return Statistic::AVERAGE;
+    }
+
+    return Statistic::AVERAGE;
+}
+
 std::string get_label(Statistic stat) {
     switch (stat) {
     case Statistic::AVERAGE:
         return "avg";
     case Statistic::SUM:
         return "sum";
+    case Statistic::MAX:
+        return "max";
+    case Statistic::MIN:
+        return "min";
+    case Statistic::P95:
+        return "p95";
+    case Statistic::P99:
+        return "p99";
     }
+
+    return "N/A";
+}
+
+bool is_distribution(Statistic stat) {
+    return (stat != Statistic::AVERAGE) && (stat != Statistic::SUM);
 }
 
 } // namespace sampling
-} // namespace bandwit
\ No newline at end of file
+} // namespace bandwit
@@ -1,6 +1,8 @@
-#include <fstream>
+#include <array>
+#include <fcntl.h>
 #include <sstream>
 #include <stdexcept>
+#include <sys/stat.h>
 
 #include "aliases.hpp"
 #include "except.hpp"
@@ -9,17 +11,24 @@
 namespace bandwit {
 namespace sampling {
 
-uint64_t SysFsParser::read_file_as_number(const std::string &filepath) const {
-    std::ifstream fl{filepath};
-    if (!fl) {
-        THROW_ARGS(std::runtime_error, "failed to open file for reading: %s",
-                   filepath.c_str());
+uint64_t SysFsParser::parse_number(const char *buf, std::size_t len) const {
+    uint64_t num = 0;
+    std::size_t i = 0;
+
+    // the file contains just the number followed by a newline
+    for (; i < len; ++i) {
+        char ch = buf[i];
+        if ((ch < '0') || (ch > '9')) {
+            break;
+        }
+        num = num * 10 + U64(ch - '0');
     }
 
-    std::string contents{};
-    getline(fl, contents);
+    if (i == 0) {
+        THROW_MSG(std::runtime_error, "failed to parse number from file");
+    }
 
-    return std::stoul(contents);
+    return num;
 }
 
 std::string SysFsParser::create_filepath(const std::string &iface_name,
@@ -30,18 +39,163 @@ std::string SysFsParser::create_filepath(const std::string &iface_name,
     return ss.str();
 }
 
-uint64_t SysFsParser::read(const std::string &iface_name,
-                           const Quantity &qtty) const {
-    std::string filepath = create_filepath(iface_name, qtty);
-    return read_file_as_number(filepath);
+SysFsCounterFile::SysFsCounterFile(std::string filepath)
+    : filepath_{std::move(filepath)} {}
+
+SysFsCounterFile::~SysFsCounterFile() { close_file(); }
+
+bool SysFsCounterFile::open_file() {
+    close_file();
+
+    fd_ = open(filepath_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        return false;
+    }
+
+    struct stat st {};
+    if (fstat(fd_, &st) < 0) {
+        close_file();
+        return false;
+    }
+
+    device_ = st.st_dev;
+    inode_ = st.st_ino;
+    return true;
+}
+
+void SysFsCounterFile::close_file() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool SysFsCounterFile::is_stale() const {
+    if (fd_ < 0) {
+        return true;
+    }
+
+    // If the interface was renamed or removed the path no longer exists. If
+    // it was removed and plugged back in (or another interface took the name)
+    // the path exists but belongs to a different file than the one we have
+    // open.
+    struct stat st {};
+    if (stat(filepath_.c_str(), &st) < 0) {
+        return true;
+    }
+
+    return (st.st_dev != device_) || (st.st_ino != inode_);
+}
+
+ssize_t SysFsCounterFile::read_into(char *buf, std::size_t len) const {
+    return pread(fd_, buf, len, 0);
+}
+
+SysFsSampler::IfaceFiles &
+SysFsSampler::get_files(const std::string &iface_name) {
+    auto it = files_.find(iface_name);
+    if (it != files_.end()) {
+        return *it->second;
+    }
+
+    auto rx_path =
+        parser_.create_filepath(iface_name, SysFsParser::Quantity::RX_BYTES);
+    auto tx_path =
+        parser_.create_filepath(iface_name, SysFsParser::Quantity::TX_BYTES);
+
+    auto files = std::make_unique<IfaceFiles>(IfaceFiles{
+        std::make_unique<SysFsCounterFile>(rx_path),
+        std::make_unique<SysFsCounterFile>(tx_path),
+        0,
+        0,
+        check_every_,
+    });
+
+    // The first time around the files have to be there, otherwise this sampler
+    // does not work for this interface.
+    if (!files->rx->open_file()) {
+        THROW_ARGS(std::runtime_error, "failed to open file for reading: %s",
+                   rx_path.c_str());
+    }
+    if (!files->tx->open_file()) {
+        THROW_ARGS(std::runtime_error, "failed to open file for reading: %s",
+                   tx_path.c_str());
+    }
+
+    auto &ref = *files;
+    files_.emplace(iface_name, std::move(files));
+    return ref;
+}
+
+bool SysFsSampler::revalidate(IfaceFiles &files) {
+    if (files.rx->is_stale() && !files.rx->open_file()) {
+        return false;
+    }
+    if (files.tx->is_stale() && !files.tx->open_file()) {
+        return false;
+    }
+    return true;
+}
+
+bool SysFsSampler::read_counter(const SysFsCounterFile &file,
+                                uint64_t &value) const {
+    // u64 max is 20 digits, plus a newline
+    std::array<char, 32> buf{};
+
+    auto nread = file.read_into(buf.data(), buf.size());
+    if (nread <= 0) {
+        return false;
+    }
+
+    value = parser_.parse_number(buf.data(), SIZE_T(nread));
+    return true;
+}
+
+bool SysFsSampler::read_counters(IfaceFiles &files, uint64_t &rx,
+                                 uint64_t &tx) {
+    if (files.ticks_to_check == 0) {
+        files.ticks_to_check = check_every_;
+        if (!revalidate(files)) {
+            return false;
+        }
+    }
+    --files.ticks_to_check;
+
+    if (read_counter(*files.rx, rx) && read_counter(*files.tx, tx)) {
+        return true;
+    }
+
+    // The device went away under our open fd (reads fail with ENODEV), or the
+    // files were closed last time. Reopen them, in case the interface is back.
+    files.rx->close_file();
+    files.tx->close_file();
+    if (!revalidate(files)) {
+        return false;
+    }
+
+    return read_counter(*files.rx, rx) && read_counter(*files.tx, tx);
 }
 
-Sample SysFsSampler::get_sample(const std::string &iface_name) const {
-    auto tp = Clock::now();
-    std::time_t ts = Clock::to_time_t(tp);
+Sample SysFsSampler::get_sample(const std::string &iface_name) {
+    TimePoint ts = Clock::now();
 
-    uint64_t rx = parser_.read(iface_name, SysFsParser::Quantity::RX_BYTES);
-    uint64_t tx = parser_.read(iface_name, SysFsParser::Quantity::TX_BYTES);
+    auto &files = get_files(iface_name);
+
+    uint64_t rx = files.last_rx;
+    uint64_t tx = files.last_tx;
+
+    // While the interface is gone we keep reporting the last counters we saw,
+    // which amounts to no traffic. Once it comes back we start reading from
+    // the newly opened files.
+    if (read_counters(files, rx, tx)) {
+        files.last_rx = rx;
+        files.last_tx = tx;
+    } else {
+        files.rx->close_file();
+        files.tx->close_file();
+        rx = files.last_rx;
+        tx = files.last_tx;
+    }
 
     Sample sample{
         rx,
@@ -53,4 +207,4 @@ Sample SysFsSampler::get_sample(const std::string &iface_name) const {
 }
 
 } // namespace sampling
-} // namespace bandwit
\ No newline at end of file
+} // namespace bandwit
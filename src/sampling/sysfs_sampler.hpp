@@ -1,7 +1,9 @@
 #ifndef SYSFS_SAMPLER_H
 #define SYSFS_SAMPLER_H
 
+#include <memory>
 #include <string>
+#include <sys/types.h>
 #include <unistd.h>
 #include <unordered_map>
 
@@ -17,10 +19,9 @@ class SysFsParser {
         TX_BYTES,
     };
 
-    uint64_t read_file_as_number(const std::string &filepath) const;
+    uint64_t parse_number(const char *buf, std::size_t len) const;
     std::string create_filepath(const std::string &iface_name,
                                 const Quantity &qtty) const;
-    uint64_t read(const std::string &iface_name, const Quantity &qtty) const;
 
   private:
     std::unordered_map<Quantity, std::string> quantity_filenames_{
@@ -29,6 +30,32 @@ class SysFsParser {
     };
 };
 
+// A counter file in sysfs that we open once and then re-read from the start
+// with pread() on every sample. sysfs regenerates the contents on every read
+// at offset 0, so there is no need to reopen the file to see a new value.
+class SysFsCounterFile {
+  public:
+    explicit SysFsCounterFile(std::string filepath);
+    ~SysFsCounterFile();
+
+    CLASS_DISABLE_COPIES(SysFsCounterFile)
+    CLASS_DISABLE_MOVES(SysFsCounterFile)
+
+    bool open_file();
+    void close_file();
+    bool is_stale() const;
+    ssize_t read_into(char *buf, std::size_t len) const;
+
+  private:
+    std::string filepath_{};
+    int fd_{-1};
+
+    // identity of the file we have open, to detect when the path starts
+    // pointing at a different file
+    dev_t device_{0};
+    ino_t inode_{0};
+};
+
 class SysFsSampler : public Sampler {
   public:
     SysFsSampler() = default;
@@ -37,13 +64,38 @@ class SysFsSampler : public Sampler {
     CLASS_DISABLE_COPIES(SysFsSampler)
     CLASS_DISABLE_MOVES(SysFsSampler)
 
-    Sample get_sample(const std::string &iface_name) const override;
+    Sample get_sample(const std::string &iface_name) override;
 
   private:
+    struct IfaceFiles {
+        std::unique_ptr<SysFsCounterFile> rx;
+        std::unique_ptr<SysFsCounterFile> tx;
+
+        // the counters we read last, reused while the interface is gone
+        uint64_t last_rx;
+        uint64_t last_tx;
+
+        // samples left until we check that the paths still lead to the files
+        // we have open
+        std::size_t ticks_to_check;
+    };
+
+    IfaceFiles &get_files(const std::string &iface_name);
+    bool revalidate(IfaceFiles &files);
+    bool read_counter(const SysFsCounterFile &file, uint64_t &value) const;
+    bool read_counters(IfaceFiles &files, uint64_t &rx, uint64_t &tx);
+
     SysFsParser parser_{};
+
+    // Reads fail once the interface is removed, which is how we notice it
+    // most of the time. A rename doesn't make them fail though, so every so
+    // many samples we stat the paths as well.
+    std::size_t check_every_{16};
+
+    std::unordered_map<std::string, std::unique_ptr<IfaceFiles>> files_{};
 };
 
 } // namespace sampling
 } // namespace bandwit
 
-#endif // SYSFS_SAMPLER_H
\ No newline at end of file
+#endif // SYSFS_SAMPLER_H
@@ -1,128 +1,380 @@
-#include "time_series.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#include "except.hpp"
 #include "macros.hpp"
+#include "time_series.hpp"
 
 namespace bandwit {
 namespace sampling {
 
-void TimeSeries::inc(TimePoint tp, uint64_t value) {
-    // are we well over size?
-    if (F64(size()) > F64(max_capacity_) * oversize_factor_) {
-        truncate();
+// The size of the blocks that are compressed once they're full. A slice decodes
+// whole blocks, so this is also the granularity of decoding.
+static constexpr std::size_t max_block_size = 64;
+
+TimeSeries::TimeSeries(Millis sampling_interval, TimePoint start,
+                       std::size_t capacity, std::size_t num_columns)
+    : sampling_interval_{sampling_interval}, start_{start},
+      interval_divider_{U64(
+          std::chrono::duration_cast<TimePoint::duration>(sampling_interval)
+              .count())},
+      max_capacity_{check_capacity(capacity)},
+      block_size_{std::min(capacity, max_block_size)},
+      block_shift_{log2(block_size_)}, block_mask_{block_size_ - 1},
+      num_columns_{num_columns}, hot_(num_columns * block_size_),
+      hot_base_(num_columns),
+      block_sums_{0, 0, false, std::vector<uint64_t>(block_size_ + 1)} {
+    for (std::size_t column = 0; column < num_columns_; ++column) {
+        sealed_.emplace_back(block_size_, capacity / block_size_);
     }
+}
 
+void TimeSeries::inc(TimePoint tp, const uint64_t *values) {
     std::size_t key = calculate_key(tp);
-    auto current_value = ((key <= max_key_) && (size() > 0)) ? get_key(key) : 0;
-    set_key(key, current_value + value);
+    if (!prepare_key(key)) {
+        return;
+    }
+
+    auto block_index = key >> block_shift_;
+    auto offset = key & block_mask_;
+
+    // the common case: every column in the hot block, in one go
+    if (block_index == hot_block_) {
+        for (std::size_t column = 0; column < num_columns_; ++column) {
+            hot_[column * block_size_ + offset] += values[column];
+        }
+        return;
+    }
+
+    for (std::size_t column = 0; column < num_columns_; ++column) {
+        write_key(key, column, get_key(key, column) + values[column]);
+    }
 }
 
-uint64_t TimeSeries::get(TimePoint tp) const {
+uint64_t TimeSeries::get(TimePoint tp, std::size_t column) const {
     std::size_t key = calculate_key(tp);
-    return get_key(key);
+    return get_key(key, column);
 }
 
-TimeSeriesSlice TimeSeries::get_slice_from_point(TimePoint tp, std::size_t len,
-                                                 Statistic stat) const {
-    auto last_key = calculate_key(tp);
-    auto first_key = len > (last_key + 1) ? 0 : last_key + 1 - len;
+void TimeSeries::get_slice_from_point(std::size_t column, TimePoint tp,
+                                      std::size_t len, Millis window,
+                                      Statistic stat, uint64_t pending,
+                                      TimeSeriesSlice &slice) const {
+    auto factor = check_window(window);
 
-    auto agg_window = aggregation_window();
+    if (is_distribution(stat)) {
+        THROW_ARGS(std::runtime_error, "time series only has sums, not %s",
+                   get_label(stat).c_str());
+    }
+
+    auto last_bucket = calculate_key(tp) / factor;
+    auto first_bucket = len > (last_bucket + 1) ? 0 : last_bucket + 1 - len;
+    first_bucket = std::max(first_bucket, min_key_ / factor);
 
+    if ((size() == 0) || (last_bucket > max_key_ / factor)) {
+        THROW_ARGS(std::out_of_range, "key out of range: %zu",
+                   last_bucket * factor);
+    }
+
+    // For the average we report bytes per second, whatever the length of the
+    // window. Windows shorter than a second have to be scaled up.
+    uint64_t multiplier = 1;
     uint64_t divisor = 1;
     if (stat == Statistic::AVERAGE) {
-        divisor = U64(agg_window);
+        auto window_ms = U64(window.count());
+        if (window_ms % 1000 == 0) {
+            divisor = window_ms / 1000;
+        } else {
+            multiplier = 1000;
+            divisor = window_ms;
+        }
     }
 
-    std::vector<TimePoint> time_points(last_key + 1 - first_key);
-    std::vector<uint64_t> values(time_points.size());
-    std::size_t i = 0;
+    slice.values.resize(last_bucket + 1 - first_bucket);
+    slice.start = reverse_key(first_bucket * factor);
+    slice.agg_window = window_from_length(window);
 
-    for (auto cursor = first_key; cursor <= last_key; ++cursor) {
-        auto tp = reverse_key(cursor);
-        auto value = get_key(cursor);
+    // Every bucket is the difference of the prefix sums at its ends, so it
+    // costs the same whatever the number of keys in it. Consecutive buckets
+    // share an end, and a block is only turned into prefix sums once.
+    auto lower =
+        get_prefix_sum(std::max(first_bucket * factor, min_key_), column);
 
-        time_points[i] = tp;
-        values[i] = value / divisor;
+    for (auto bucket = first_bucket; bucket <= last_bucket; ++bucket) {
+        auto end_key = std::min((bucket + 1) * factor, max_key_ + 1);
+        auto upper = get_prefix_sum(end_key, column);
 
-        ++i;
-    }
+        uint64_t value = upper - lower;
+        if (bucket == max_key_ / factor) {
+            value += pending;
+        }
 
-    TimeSeriesSlice slice{time_points, values, agg_window};
-    return slice;
+        slice.values[bucket - first_bucket] = value * multiplier / divisor;
+
+        lower = upper;
+    }
 }
 
-TimePoint TimeSeries::min() const { return start_; }
+TimePoint TimeSeries::min(Millis window) const {
+    auto factor = check_window(window);
+    return reverse_key(min_key_ / factor * factor);
+}
 
-TimePoint TimeSeries::max() const { return reverse_key(max_key_); }
+TimePoint TimeSeries::max(Millis window) const {
+    auto factor = check_window(window);
+    return reverse_key(max_key_ / factor * factor);
+}
 
-std::optional<TimePoint> TimeSeries::minus_one(TimePoint tp) const {
-    int key = INT(calculate_key(tp));
-    --key;
+std::optional<TimePoint> TimeSeries::minus_one(TimePoint tp,
+                                               Millis window) const {
+    auto factor = check_window(window);
+    auto bucket = calculate_key(tp) / factor;
 
-    if ((key < 0) || (key > INT(max_key_))) {
+    if ((bucket <= min_key_ / factor) || (bucket > max_key_ / factor + 1)) {
         return std::nullopt;
     }
 
-    TimePoint res = reverse_key(SIZE_T(key));
+    TimePoint res = reverse_key((bucket - 1) * factor);
     return std::optional<TimePoint>(res);
 }
 
-std::optional<TimePoint> TimeSeries::plus_one(TimePoint tp) const {
-    int key = INT(calculate_key(tp));
-    ++key;
+std::optional<TimePoint> TimeSeries::plus_one(TimePoint tp,
+                                              Millis window) const {
+    auto factor = check_window(window);
+    auto bucket = calculate_key(tp) / factor;
 
-    if ((key < 0) || (key > INT(max_key_))) {
+    if ((bucket + 1 < min_key_ / factor) || (bucket >= max_key_ / factor)) {
         return std::nullopt;
     }
 
-    TimePoint res = reverse_key(SIZE_T(key));
+    TimePoint res = reverse_key((bucket + 1) * factor);
     return std::optional<TimePoint>(res);
 }
 
-void TimeSeries::set_key(std::size_t key, uint64_t value) {
-    // We can't use operator[] to set an element that doesn't exist in the
-    // vector yet so we need to enlarge it proactively. The new slots will be
-    // filled with zeroes, which is our null value anyway.
-    if (key >= storage_.size()) {
-        // double the vector size
-        storage_.resize((key + 1) * 2);
+void TimeSeries::set_key(std::size_t key, const uint64_t *values) {
+    if (!prepare_key(key)) {
+        return;
+    }
+
+    for (std::size_t column = 0; column < num_columns_; ++column) {
+        write_key(key, column, values[column]);
+    }
+}
+
+uint64_t TimeSeries::get_key(std::size_t key, std::size_t column) const {
+    check_key(key, column);
+
+    auto block_index = key >> block_shift_;
+    auto offset = key & block_mask_;
+
+    if (block_index == hot_block_) {
+        return hot_[column * block_size_ + offset];
     }
 
-    storage_[key] = value;
+    const auto &sums = get_block_sums(column, block_index);
+    return sums[offset + 1] - sums[offset];
+}
+
+uint64_t TimeSeries::get_prefix_sum(std::size_t key,
+                                    std::size_t column) const {
+    // one past the max key is allowed
+    check_key(key == max_key_ + 1 ? max_key_ : key, column);
+
+    auto block_index = key >> block_shift_;
+    auto offset = key & block_mask_;
+
+    // one past the max key, at the start of the next block
+    if (block_index > hot_block_) {
+        block_index = hot_block_;
+        offset = block_size_;
+    }
 
-    // update invariants
-    max_key_ = key > max_key_ ? key : max_key_;
-    size_ = max_key_ + 1;
+    return get_block_sums(column, block_index)[offset];
 }
 
-uint64_t TimeSeries::get_key(std::size_t key) const { return storage_.at(key); }
+const std::vector<uint64_t> &
+TimeSeries::get_block_sums(std::size_t column, std::size_t block_index) const {
+    if (block_sums_.is_valid && (block_sums_.column == column) &&
+        (block_sums_.block_index == block_index)) {
+        return block_sums_.sums;
+    }
 
-AggregationWindow TimeSeries::aggregation_window() const {
-    Millis one_sec{1000};
-    uint32_t multiplier = sampling_interval_ / one_sec;
+    auto &sums = block_sums_.sums;
+
+    if (block_index == hot_block_) {
+        const auto *hot = hot_.data() + column * block_size_;
+        sums[0] = hot_base_[column];
+        for (std::size_t i = 0; i < block_size_; ++i) {
+            sums[i + 1] = sums[i] + hot[i];
+        }
+    } else {
+        // decode into the tail, so that the sums can overwrite the values as
+        // they go
+        const auto &sealed = sealed_[column];
+        sealed.decode(block_index, sums.data() + 1);
+        sums[0] = sealed.get_base(block_index);
+        for (std::size_t i = 0; i < block_size_; ++i) {
+            sums[i + 1] += sums[i];
+        }
+    }
+
+    block_sums_.column = column;
+    block_sums_.block_index = block_index;
+    block_sums_.is_valid = true;
+    return sums;
+}
 
+AggregationWindow TimeSeries::aggregation_window() const {
     // this will fail if sampling_interval_ does not match any
     // AggregationWindow
-    return static_cast<AggregationWindow>(multiplier);
+    return static_cast<AggregationWindow>(sampling_interval_.count());
 }
 
+std::size_t TimeSeries::num_columns() const { return num_columns_; }
+
 std::size_t TimeSeries::size() const { return size_; }
 
-std::size_t TimeSeries::capacity() const { return storage_.capacity(); }
+std::size_t TimeSeries::capacity() const { return max_capacity_; }
+
+std::size_t TimeSeries::memory_usage() const {
+    std::size_t total = hot_.size() * sizeof(uint64_t);
+    for (const auto &sealed : sealed_) {
+        total += sealed.memory_usage();
+    }
+    return total;
+}
+
+std::size_t TimeSeries::check_window(Millis window) const {
+    if ((window < sampling_interval_) ||
+        (window % sampling_interval_ != Millis{0})) {
+        THROW_ARGS(std::runtime_error,
+                   "window %s is not a multiple of the sampling interval",
+                   get_label(window_from_length(window)).c_str());
+    }
+    return SIZE_T(window / sampling_interval_);
+}
+
+void TimeSeries::check_key(std::size_t key, std::size_t column) const {
+    if ((size() == 0) || (key < min_key_) || (key > max_key_)) {
+        THROW_ARGS(std::out_of_range, "key out of range: %zu", key);
+    }
+    if (column >= num_columns_) {
+        THROW_ARGS(std::out_of_range, "column out of range: %zu", column);
+    }
+}
+
+std::size_t TimeSeries::check_capacity(std::size_t capacity) {
+    if ((capacity == 0) || ((capacity & (capacity - 1)) != 0)) {
+        THROW_ARGS(std::runtime_error,
+                   "time series capacity must be a power of two, got: %zu",
+                   capacity);
+    }
+    return capacity;
+}
+
+std::size_t TimeSeries::log2(std::size_t power_of_two) {
+    std::size_t shift = 0;
+    while ((SIZE_T(1) << shift) < power_of_two) {
+        ++shift;
+    }
+    return shift;
+}
+
+bool TimeSeries::prepare_key(std::size_t key) {
+    block_sums_.is_valid = false;
+
+    if (size() == 0) {
+        // the series starts with the first key we set
+        min_key_ = key;
+        max_key_ = min_key_;
+        hot_block_ = min_key_ >> block_shift_;
+        std::fill(hot_base_.begin(), hot_base_.end(), 0);
+        size_ = 1;
+    }
+
+    // older than anything we still keep
+    if (key < min_key_) {
+        return false;
+    }
+
+    if (key > max_key_) {
+        advance_block(key >> block_shift_);
 
-void TimeSeries::truncate() {
-    int num_to_remove = size() - max_capacity_;
-    storage_.erase(storage_.begin(), storage_.begin() + num_to_remove);
+        max_key_ = key;
+        if (max_key_ - min_key_ + 1 > max_capacity_) {
+            min_key_ = max_key_ + 1 - max_capacity_;
+        }
+    }
+
+    return true;
+}
+
+void TimeSeries::write_key(std::size_t key, std::size_t column,
+                           uint64_t value) {
+    block_sums_.is_valid = false;
+
+    auto block_index = key >> block_shift_;
+    auto offset = key & block_mask_;
+
+    if (block_index == hot_block_) {
+        hot_[column * block_size_ + offset] = value;
+        return;
+    }
+
+    // Writing to a sealed block is the slow path: it has to be decoded and
+    // sealed again, and the sums of the blocks after it change.
+    auto &sealed = sealed_[column];
+    std::vector<uint64_t> values(block_size_);
+    sealed.decode(block_index, values.data());
+    auto delta = value - values[offset];
+    values[offset] = value;
+    sealed.seal(block_index, values.data(), sealed.get_base(block_index));
+
+    sealed.adjust_bases_after(block_index, delta);
+    hot_base_[column] += delta;
+}
+
+void TimeSeries::advance_block(std::size_t block_index) {
+    if (block_index == hot_block_) {
+        return;
+    }
+
+    // The blocks we skipped over had no traffic. The store only has room for
+    // the most recent ones, so there is no point in sealing the rest.
+    auto first_empty = hot_block_ + 1;
+    auto num_blocks = max_capacity_ / block_size_;
+    if (block_index - first_empty > num_blocks) {
+        first_empty = block_index - num_blocks;
+    }
+
+    for (std::size_t column = 0; column < num_columns_; ++column) {
+        auto &sealed = sealed_[column];
+        auto *hot = hot_.data() + column * block_size_;
+
+        sealed.seal(hot_block_, hot, hot_base_[column]);
 
-    // update invariants
-    start_ += sampling_interval_ * num_to_remove;
-    max_key_ -= num_to_remove;
-    size_ -= num_to_remove;
+        uint64_t base = hot_base_[column];
+        for (std::size_t i = 0; i < block_size_; ++i) {
+            base += hot[i];
+        }
+
+        for (auto index = first_empty; index < block_index; ++index) {
+            sealed.seal_empty(index, base);
+        }
+
+        hot_base_[column] = base;
+    }
+
+    std::fill(hot_.begin(), hot_.end(), 0);
+    hot_block_ = block_index;
 }
 
 std::size_t TimeSeries::calculate_key(TimePoint tp) const {
     auto distance = (tp - start_);
-    auto num_units = distance / sampling_interval_;
-    return num_units;
+    if (distance.count() < 0) {
+        return SIZE_T(distance / sampling_interval_);
+    }
+    return interval_divider_.divide(U64(distance.count()));
 }
 
 TimePoint TimeSeries::reverse_key(std::size_t index) const {
@@ -131,4 +383,4 @@ TimePoint TimeSeries::reverse_key(std::size_t index) const {
 }
 
 } // namespace sampling
-} // namespace bandwit
\ No newline at end of file
+} // namespace bandwit
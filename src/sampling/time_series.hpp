@@ -5,48 +5,112 @@
 #include <vector>
 
 #include "aliases.hpp"
+#include "block_store.hpp"
 #include "sampling/agg_window.hpp"
 #include "sampling/statistic.hpp"
 #include "sampling/time_series_slice.hpp"
+#include "tools/divider.hpp"
 
 namespace bandwit {
 namespace sampling {
 
+// There are `num_columns` values for every key, eg. the bytes received and
+// the bytes transmitted. The columns share the keys, so that a sample for all
+// of them is a single update.
 class TimeSeries {
   public:
-    TimeSeries(Millis sampling_interval, TimePoint start)
-        : sampling_interval_{sampling_interval}, start_{start} {}
+    // `capacity` has to be a power of two
+    TimeSeries(Millis sampling_interval, TimePoint start, std::size_t capacity,
+               std::size_t num_columns);
 
     // convenience API using time points
-    void inc(TimePoint tp, uint64_t value);
-    uint64_t get(TimePoint tp) const;
-    TimeSeriesSlice get_slice_from_point(TimePoint tp, std::size_t len,
-                                         Statistic stat) const;
+    // adds a value to every column, `values` has one for each
+    void inc(TimePoint tp, const uint64_t *values);
+    uint64_t get(TimePoint tp, std::size_t column) const;
 
-    TimePoint min() const;
-    TimePoint max() const;
-    std::optional<TimePoint> minus_one(TimePoint tp) const;
-    std::optional<TimePoint> plus_one(TimePoint tp) const;
+    // The slice and cursor methods work on buckets of `window`, which has to
+    // be a whole number of sampling intervals. Its buckets are counted from
+    // `start` as well.
+    //
+    // `pending` is traffic that has not been added to the last bucket yet,
+    // but belongs in it
+    void get_slice_from_point(std::size_t column, TimePoint tp,
+                              std::size_t len, Millis window, Statistic stat,
+                              uint64_t pending, TimeSeriesSlice &slice) const;
 
-    // underlying API using vector indices
-    void set_key(std::size_t key, uint64_t value);
-    uint64_t get_key(std::size_t key) const;
+    TimePoint min(Millis window) const;
+    TimePoint max(Millis window) const;
+    std::optional<TimePoint> minus_one(TimePoint tp, Millis window) const;
+    std::optional<TimePoint> plus_one(TimePoint tp, Millis window) const;
+
+    // underlying API using keys, which count intervals since `start`
+    // sets every column, `values` has one for each
+    void set_key(std::size_t key, const uint64_t *values);
+    uint64_t get_key(std::size_t key, std::size_t column) const;
+    // the sum of the values before `key`, which may be one past the max key
+    uint64_t get_prefix_sum(std::size_t key, std::size_t column) const;
 
     AggregationWindow aggregation_window() const;
+    std::size_t num_columns() const;
     std::size_t size() const;
     std::size_t capacity() const;
-    void truncate();
+    std::size_t memory_usage() const;
 
     std::size_t calculate_key(TimePoint tp) const;
     TimePoint reverse_key(std::size_t index) const;
 
   private:
+    // The prefix sums of a single block of a column: sums[i] is the sum of
+    // the values before offset i in the block.
+    struct BlockSums {
+        std::size_t column;
+        std::size_t block_index;
+        bool is_valid;
+        std::vector<uint64_t> sums;
+    };
+
+    static std::size_t check_capacity(std::size_t capacity);
+    static std::size_t log2(std::size_t power_of_two);
+    std::size_t check_window(Millis window) const;
+    void check_key(std::size_t key, std::size_t column) const;
+
+    // makes room for `key`, returns false if it is too old to keep
+    bool prepare_key(std::size_t key);
+    void write_key(std::size_t key, std::size_t column, uint64_t value);
+    void advance_block(std::size_t block_index);
+    const std::vector<uint64_t> &get_block_sums(std::size_t column,
+                                                std::size_t block_index) const;
+
     Millis sampling_interval_{};
     TimePoint start_{};
-    std::size_t max_capacity_{512};
-    double oversize_factor_{1.2};
+    // Turning a time point into a key is on the path of every sample, so the
+    // division by the interval is done with a precomputed reciprocal.
+    tools::Divider interval_divider_;
+
+    // The values of keys min_key_ to max_key_ are stored in blocks of
+    // block_size_ consecutive keys. The newest block is kept as is, so that
+    // writing to it is cheap. The blocks before it are sealed and compressed.
+    std::size_t max_capacity_{0};
+    std::size_t block_size_{0};
+    // block_size_ is a power of two, these split a key into block and offset
+    std::size_t block_shift_{0};
+    std::size_t block_mask_{0};
+    std::size_t num_columns_{0};
+
+    // the hot block of every column, one after the other
+    std::vector<uint64_t> hot_{};
+    std::size_t hot_block_{0};
+    // per column, the sum of all the values before the hot block
+    std::vector<uint64_t> hot_base_{};
+    // per column
+    std::vector<BlockStore> sealed_{};
+
+    // The block that was turned into prefix sums last, so that reading the
+    // keys of a block one after the other decodes it once. Any write makes it
+    // stale.
+    mutable BlockSums block_sums_;
 
-    std::vector<uint64_t> storage_{};
+    std::size_t min_key_{0};
     std::size_t max_key_{0};
     std::size_t size_{0};
 };
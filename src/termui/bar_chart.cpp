@@ -16,10 +16,18 @@ namespace termui {
 void BarChart::draw_bars_from_right(const std::string &iface_name,
                                     const std::string &title,
                                     const TimeSeriesSlice &slice,
-                                    DisplayScale scale, Statistic stat) {
+                                    DisplayScale scale, Statistic stat,
+                                    const std::string &status) {
     auto dim = surface_->get_size();
     std::vector<uint16_t> scaled{};
 
+    // The bars reach up to the title, which is drawn over them. The status
+    // goes on the row below the title, so the bars stop short of it.
+    uint16_t bottom_edge = dim.height - chart_offset_;
+    uint16_t top_edge = status.empty() ? 1 : 3;
+    uint16_t vertical_space =
+        bottom_edge >= top_edge ? bottom_edge - top_edge + 1 : 0;
+
     auto max = std::max_element(slice.values.begin(), slice.values.end());
     uint64_t max_value = *max;
 
@@ -27,7 +35,7 @@ void BarChart::draw_bars_from_right(const std::string &iface_name,
 
         for (auto it = slice.values.rbegin(); it != slice.values.rend(); ++it) {
             double perc = F64(*it) / F64(max_value);
-            auto magnitude = U64(perc * F64(dim.height - chart_offset_));
+            auto magnitude = U64(perc * F64(vertical_space));
             scaled.push_back(magnitude);
         }
 
@@ -46,11 +54,10 @@ void BarChart::draw_bars_from_right(const std::string &iface_name,
         }
     }
 
+    shift_if_scrolled(dim, vertical_space, slice, max_value, scale, stat);
     surface_->clear_surface();
 
     uint16_t col_cur = dim.width;
-    uint16_t bottom_edge = dim.height - chart_offset_;
-    uint16_t vertical_space = bottom_edge;
     for (auto value : scaled) {
         if (value == 0) {
             Point pt{col_cur, bottom_edge};
@@ -66,25 +73,68 @@ void BarChart::draw_bars_from_right(const std::string &iface_name,
         --col_cur;
     }
 
-    draw_yaxis(dim, max_value, scale, stat);
+    draw_yaxis(dim, vertical_space, max_value, scale, stat);
     draw_xaxis(dim, slice);
     draw_yaxis_label(dim, scale);
     draw_title(title, slice, stat);
     draw_menu(iface_name, dim);
+    draw_status(status, dim);
 
     surface_->flush();
 }
 
-void BarChart::draw_yaxis(const Dimensions &dim, uint64_t max_value,
-                          DisplayScale scale, Statistic stat) {
+void BarChart::shift_if_scrolled(const Dimensions &dim,
+                                 uint16_t vertical_space,
+                                 const TimeSeriesSlice &slice,
+                                 uint64_t max_value, DisplayScale scale,
+                                 Statistic stat) {
+    Frame frame{true, dim, vertical_space, slice.agg_window, slice.size(),
+                slice.time_point(slice.size() - 1), max_value, scale, stat};
+    Frame prev = prev_frame_;
+    prev_frame_ = frame;
+
+    // Anything but time having moved on changes the bars or the axis, and the
+    // whole chart is drawn anew. The height of a linear bar depends on the
+    // max, a log one doesn't.
+    if (!prev.is_valid || (prev.dim.width != dim.width) ||
+        (prev.dim.height != dim.height) ||
+        (prev.vertical_space != vertical_space) ||
+        (prev.window != frame.window) ||
+        (prev.len != frame.len) || (prev.scale != scale) ||
+        (prev.stat != stat) ||
+        ((scale == DisplayScale::LINEAR) && (prev.max_value != max_value))) {
+        return;
+    }
+
+    auto interval = sampling::get_interval(slice.agg_window);
+    auto distance = frame.last - prev.last;
+    if (distance % interval != Clock::duration{0}) {
+        return;
+    }
+
+    // the bars move left as time moves forward
+    auto columns = -INT(distance / interval);
+    if ((columns == 0) || (std::abs(columns) >= INT(frame.len))) {
+        return;
+    }
+
+    // the bars and the x axis below them, the y axis stays put
+    auto x_from = U16(dim.width - frame.len + 1);
+    auto y_to = U16(dim.height - xaxis_offset_);
+    surface_->shift_columns(x_from, 1, y_to, columns);
+}
+
+void BarChart::draw_yaxis(const Dimensions &dim, uint16_t vertical_space,
+                          uint64_t max_value, DisplayScale scale,
+                          Statistic stat) {
     std::vector<uint64_t> ticks{};
     std::vector<std::string> ticks_fmt{};
     YAxisScale y_scale = YAxisScale::BASE2;
 
     if (scale == DisplayScale::LINEAR) {
 
-        double factor = 1.0 / F64(dim.height);
-        for (int x = 1; x <= dim.height - chart_offset_; ++x) {
+        double factor = 1.0 / F64(vertical_space + chart_offset_);
+        for (int x = 1; x <= vertical_space; ++x) {
             auto tick = U64(F64(max_value) * (x * factor));
             ticks.push_back(tick);
         }
@@ -92,7 +142,7 @@ void BarChart::draw_yaxis(const Dimensions &dim, uint64_t max_value,
     } else if (scale == DisplayScale::LOG10) {
         y_scale = YAxisScale::BASE10;
 
-        for (int x = 0; x < dim.height - chart_offset_; ++x) {
+        for (int x = 0; x < vertical_space; ++x) {
             double tick = std::pow(10.0, F64(x));
             if (tick < std::numeric_limits<uint64_t>::max()) {
                 ticks.push_back(U64(tick));
@@ -101,7 +151,7 @@ void BarChart::draw_yaxis(const Dimensions &dim, uint64_t max_value,
 
     } else if (scale == DisplayScale::LOG2) {
 
-        for (int x = 0; x < dim.height - chart_offset_; ++x) {
+        for (int x = 0; x < vertical_space; ++x) {
             double tick = std::pow(2.0, F64(x));
             if (tick < std::numeric_limits<uint64_t>::max()) {
                 ticks.push_back(U64(tick));
@@ -111,10 +161,11 @@ void BarChart::draw_yaxis(const Dimensions &dim, uint64_t max_value,
 
     for (const auto &tick : ticks) {
         std::string tick_fmt{};
-        if (stat == Statistic::AVERAGE) {
-            tick_fmt = formatter_.format_num_bytes_rate(y_scale, tick, "s");
-        } else if (stat == Statistic::SUM) {
+        // everything but the sum is a rate
+        if (stat == Statistic::SUM) {
             tick_fmt = formatter_.format_num_bytes(y_scale, tick);
+        } else {
+            tick_fmt = formatter_.format_num_bytes_rate(y_scale, tick, "s");
         }
         ticks_fmt.push_back(std::move(tick_fmt));
     }
@@ -130,17 +181,38 @@ void BarChart::draw_xaxis(const Dimensions &dim, const TimeSeriesSlice &slice) {
     FormattedString axis{};
 
     switch (slice.agg_window) {
+    case AggregationWindow::HUNDRED_MILLIS:
+    case AggregationWindow::QUARTER_SECOND:
+    case AggregationWindow::HALF_SECOND:
+        axis = formatter_.format_xaxis_per_subsec(slice);
+        break;
     case AggregationWindow::ONE_SECOND:
-        axis = formatter_.format_xaxis_per_sec(slice.time_points);
+        axis = formatter_.format_xaxis_per_sec(slice);
         break;
     case AggregationWindow::ONE_MINUTE:
-        axis = formatter_.format_xaxis_per_min(slice.time_points);
+        axis = formatter_.format_xaxis_per_min(slice);
         break;
     case AggregationWindow::ONE_HOUR:
-        axis = formatter_.format_xaxis_per_hour(slice.time_points);
+        axis = formatter_.format_xaxis_per_hour(slice);
         break;
     case AggregationWindow::ONE_DAY:
-        axis = formatter_.format_xaxis_per_day(slice.time_points);
+        axis = formatter_.format_xaxis_per_day(slice);
+        break;
+    default:
+        // Not a window we keep, eg. 5 seconds. Label it like the largest one
+        // we keep that it doesn't fall short of.
+        auto interval = sampling::get_interval(slice.agg_window);
+        if (interval < Millis{1000}) {
+            axis = formatter_.format_xaxis_per_subsec(slice);
+        } else if (interval < Millis{60000}) {
+            axis = formatter_.format_xaxis_per_sec(slice);
+        } else if (interval < Millis{3600000}) {
+            axis = formatter_.format_xaxis_per_min(slice);
+        } else if (interval < Millis{86400000}) {
+            axis = formatter_.format_xaxis_per_hour(slice);
+        } else {
+            axis = formatter_.format_xaxis_per_day(slice);
+        }
         break;
     }
 
@@ -183,7 +255,7 @@ void BarChart::draw_title(const std::string &title,
 }
 
 void BarChart::draw_menu(const std::string &iface_name, const Dimensions &dim) {
-    std::string menu{" (q)uit (r)x (t)x s(c)ale (s)tat (arrow keys)"};
+    std::string menu{" (q)uit (r)x (t)x s(c)ale (s)tat (i)nfo (arrow keys)"};
     menu.resize(dim.width, ' ');
 
     // format iface
@@ -205,6 +277,25 @@ void BarChart::draw_menu(const std::string &iface_name, const Dimensions &dim) {
     surface_->put_string(pt, menu_fmt);
 }
 
+void BarChart::draw_status(const std::string &status, const Dimensions &dim) {
+    if (status.empty()) {
+        return;
+    }
+
+    // right aligned just below the title, above the bars, cut off on the left
+    // if it doesn't fit
+    std::string status_fmt = status;
+    if (status_fmt.size() > dim.width) {
+        status_fmt = status_fmt.substr(status_fmt.size() - dim.width);
+    }
+
+    auto col = U16(dim.width - status_fmt.size() + 1);
+    uint16_t y = 2;
+
+    Point pt{col, y};
+    surface_->put_string(pt, status_fmt);
+}
+
 uint16_t BarChart::get_width() const {
     auto dim = surface_->get_size();
     return dim.width - scale_width_;
@@ -26,20 +26,41 @@ class BarChart {
     void draw_bars_from_right(const std::string &iface_name,
                               const std::string &title,
                               const TimeSeriesSlice &slice, DisplayScale scale,
-                              Statistic stat);
-    void draw_yaxis(const Dimensions &dim, uint64_t max_value,
-                    DisplayScale scale, Statistic stat);
+                              Statistic stat, const std::string &status);
+    // `vertical_space` is how many rows the bars may take
+    void draw_yaxis(const Dimensions &dim, uint16_t vertical_space,
+                    uint64_t max_value, DisplayScale scale, Statistic stat);
     void draw_xaxis(const Dimensions &dim, const TimeSeriesSlice &slice);
     void draw_yaxis_label(const Dimensions &dim, DisplayScale scale);
     void draw_title(const std::string &title, const TimeSeriesSlice &slice,
                     Statistic stat);
     void draw_menu(const std::string &iface_name, const Dimensions &dim);
+    void draw_status(const std::string &status, const Dimensions &dim);
 
     uint16_t get_width() const;
 
   private:
+    // what the previous frame showed, to tell whether the bars of this one
+    // are the same ones moved along in time
+    struct Frame {
+        bool is_valid;
+        Dimensions dim;
+        uint16_t vertical_space;
+        AggregationWindow window;
+        std::size_t len;
+        TimePoint last;
+        uint64_t max_value;
+        DisplayScale scale;
+        Statistic stat;
+    };
+
+    void shift_if_scrolled(const Dimensions &dim, uint16_t vertical_space,
+                           const TimeSeriesSlice &slice, uint64_t max_value,
+                           DisplayScale scale, Statistic stat);
+
     TerminalSurface *surface_{nullptr};
     Formatter formatter_{};
+    Frame prev_frame_{};
 
     // 4 digits, a space, 4 chars, a space to delimit
     uint16_t scale_width_{10};
@@ -0,0 +1,98 @@
+#include <cerrno>
+#include <memory>
+#include <poll.h>
+#include <stdexcept>
+
+#include "event_loop.hpp"
+#include "except.hpp"
+
+namespace bandwit {
+namespace termui {
+
+// This is what actually owns the EventLoop. There can only be one EventLoop.
+static std::unique_ptr<EventLoop> EVENT_LOOP = nullptr;
+
+void EventLoop_signal_handler(int sig) {
+    if (EVENT_LOOP != nullptr) {
+        EVENT_LOOP->on_signal(sig);
+    }
+}
+
+EventLoop *EventLoop::create(int input_fd) {
+    if (EVENT_LOOP != nullptr) {
+        THROW_MSG(std::runtime_error, "Cannot construct another EventLoop!");
+    }
+
+    EVENT_LOOP = std::make_unique<EventLoop>(input_fd);
+    return EVENT_LOOP.get();
+}
+
+EventLoop::EventLoop(int input_fd) : input_fd_{input_fd} {
+    install_handler(SIGINT, &prev_sigint_);
+    install_handler(SIGWINCH, &prev_sigwinch_);
+}
+
+EventLoop::~EventLoop() {
+    sigaction(SIGINT, &prev_sigint_, nullptr);
+    sigaction(SIGWINCH, &prev_sigwinch_, nullptr);
+    EVENT_LOOP.release();
+}
+
+Events EventLoop::wait(std::optional<Millis> timeout) {
+    Events events{};
+
+    pollfd fds[4] = {
+        {input_fd_, POLLIN, 0},
+        {samples_.get_fd(), POLLIN, 0},
+        {interrupt_.get_fd(), POLLIN, 0},
+        {resize_.get_fd(), POLLIN, 0},
+    };
+
+    int timeout_ms = timeout.has_value() ? INT(timeout->count()) : -1;
+
+    // a signal interrupts the poll, its pipe tells us on the next one
+    if (poll(fds, 4, timeout_ms) < 0) {
+        if (errno == EINTR) {
+            return events;
+        }
+        THROW_CERROR(std::runtime_error, "EventLoop.wait failed in poll()");
+    }
+
+    events.input = (fds[0].revents & POLLIN) != 0;
+    events.samples = ((fds[1].revents & POLLIN) != 0) && samples_.drain();
+    events.interrupt = ((fds[2].revents & POLLIN) != 0) && interrupt_.drain();
+    events.resize = ((fds[3].revents & POLLIN) != 0) && resize_.drain();
+
+    // Once the terminal is gone there is nobody left to show anything to,
+    // and stdin would be readable for good.
+    if ((fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0) {
+        events.interrupt = true;
+    }
+
+    return events;
+}
+
+tools::WakeupPipe *EventLoop::get_sample_notifier() { return &samples_; }
+
+void EventLoop::on_signal(int sig) {
+    if (sig == SIGINT) {
+        interrupt_.notify();
+    } else if (sig == SIGWINCH) {
+        resize_.notify();
+    }
+}
+
+void EventLoop::install_handler(int sig, struct sigaction *prev) {
+    struct sigaction action {};
+    action.sa_handler = EventLoop_signal_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+
+    if (sigaction(sig, &action, prev) < 0) {
+        THROW_CERROR(std::runtime_error,
+                     "EventLoop.install_handler failed in sigaction()");
+    }
+}
+
+} // namespace termui
+} // namespace bandwit
@@ -0,0 +1,65 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <csignal>
+#include <optional>
+
+#include "aliases.hpp"
+#include "macros.hpp"
+#include "tools/wakeup_pipe.hpp"
+
+namespace bandwit {
+namespace termui {
+
+// What woke the event loop up, which may be several things at once.
+struct Events {
+    bool input{false};
+    bool samples{false};
+    bool interrupt{false};
+    bool resize{false};
+};
+
+// Blocks until there is keyboard input, a new sample, a Ctrl+C or a window
+// resize, so that an idle session only wakes up when a sample arrives.
+//
+// Signals get to the loop through a pipe their handler writes to, rather than
+// through signalfd, which only Linux has. For as long as the loop exists it
+// handles SIGINT and SIGWINCH instead of the handlers that were installed
+// before. Nothing but the write to the pipe happens in signal context.
+class EventLoop {
+  public:
+    // returns a non-owning pointer because the instance is owned by a static
+    // unique_pointer, which the signal handler can get to
+    static EventLoop *create(int input_fd);
+
+    explicit EventLoop(int input_fd);
+    ~EventLoop();
+
+    CLASS_DISABLE_COPIES(EventLoop)
+    CLASS_DISABLE_MOVES(EventLoop)
+
+    // returns no events if `timeout` passes first
+    Events wait(std::optional<Millis> timeout);
+
+    // for the sampling thread to tell us there are samples
+    tools::WakeupPipe *get_sample_notifier();
+
+    void on_signal(int sig);
+
+  private:
+    void install_handler(int sig, struct sigaction *prev);
+
+    int input_fd_{-1};
+
+    tools::WakeupPipe samples_{};
+    tools::WakeupPipe interrupt_{};
+    tools::WakeupPipe resize_{};
+
+    struct sigaction prev_sigint_ {};
+    struct sigaction prev_sigwinch_ {};
+};
+
+} // namespace termui
+} // namespace bandwit
+
+#endif // EVENT_LOOP_H
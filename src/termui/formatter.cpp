@@ -125,8 +125,10 @@ std::string Formatter::format_num_bytes_rate(YAxisScale scale, uint64_t num,
     return ss.str();
 }
 
-FormattedString Formatter::format_xaxis_per_sec(std::vector<TimePoint> points) {
+FormattedString
+Formatter::format_xaxis_per_subsec(const TimeSeriesSlice &slice) {
     std::stringstream ss{};
+    auto interval = sampling::get_interval(slice.agg_window);
 
     // If we need to write more than one char for a given point then successive
     // iterations through the loop will need to skip outputing anything at all
@@ -135,10 +137,62 @@ FormattedString Formatter::format_xaxis_per_sec(std::vector<TimePoint> points) {
 
     int num_chars_after_this_one{-1};
 
-    for (std::size_t i = 0; i < points.size(); i++) {
-        num_chars_after_this_one = points.size() - 1 - i;
+    // Label every n-th second so that there are at least 4 columns between
+    // labels
+    int cols_per_sec = INT(Millis{1000} / interval);
+    int label_every =
+        cols_per_sec >= 4 ? 1 : (4 + cols_per_sec - 1) / cols_per_sec;
+
+    for (std::size_t i = 0; i < slice.size(); i++) {
+        num_chars_after_this_one = slice.size() - 1 - i;
 
-        auto tp = points[i];
+        auto tp = slice.time_point(i);
+        int secs = time_keeping_.get_seconds(tp);
+        int millis = time_keeping_.get_millis(tp);
+
+        if (chars_to_skip > 0) {
+            chars_to_skip--;
+            continue;
+        }
+
+        // The time points are not aligned on whole seconds, so the point that
+        // starts a new second is the one that is less than an interval past it
+        bool starts_second = millis < interval.count();
+
+        if (starts_second && (secs == 0) && (num_chars_after_this_one >= 4)) {
+            // We need to output HH:MM
+            auto tick = format_HH_MM(tp);
+            ss << reverse_video(tick);
+            chars_to_skip = 4;
+        } else if (starts_second && (secs % label_every == 0) &&
+                   (num_chars_after_this_one >= 1)) {
+            // We need to output SS
+            auto tick = format_SS(tp);
+            ss << tick;
+            chars_to_skip = 1;
+        } else {
+            ss << ' ';
+        }
+    }
+
+    return FormattedString{ss.str()};
+}
+
+FormattedString
+Formatter::format_xaxis_per_sec(const TimeSeriesSlice &slice) {
+    std::stringstream ss{};
+
+    // If we need to write more than one char for a given point then successive
+    // iterations through the loop will need to skip outputing anything at all
+    // to make up for the space used.
+    int chars_to_skip{0};
+
+    int num_chars_after_this_one{-1};
+
+    for (std::size_t i = 0; i < slice.size(); i++) {
+        num_chars_after_this_one = slice.size() - 1 - i;
+
+        auto tp = slice.time_point(i);
         int secs = time_keeping_.get_seconds(tp);
 
         if (chars_to_skip > 0) {
@@ -164,7 +218,8 @@ FormattedString Formatter::format_xaxis_per_sec(std::vector<TimePoint> points) {
     return FormattedString{ss.str()};
 }
 
-FormattedString Formatter::format_xaxis_per_min(std::vector<TimePoint> points) {
+FormattedString
+Formatter::format_xaxis_per_min(const TimeSeriesSlice &slice) {
     std::stringstream ss{};
 
     // If we need to write more than one char for a given point then successive
@@ -174,10 +229,10 @@ FormattedString Formatter::format_xaxis_per_min(std::vector<TimePoint> points) {
 
     int num_chars_after_this_one{-1};
 
-    for (std::size_t i = 0; i < points.size(); i++) {
-        num_chars_after_this_one = points.size() - 1 - i;
+    for (std::size_t i = 0; i < slice.size(); i++) {
+        num_chars_after_this_one = slice.size() - 1 - i;
 
-        auto tp = points[i];
+        auto tp = slice.time_point(i);
         int hours = time_keeping_.get_hours(tp);
         int mins = time_keeping_.get_minutes(tp);
 
@@ -210,7 +265,7 @@ FormattedString Formatter::format_xaxis_per_min(std::vector<TimePoint> points) {
 }
 
 FormattedString
-Formatter::format_xaxis_per_hour(std::vector<TimePoint> points) {
+Formatter::format_xaxis_per_hour(const TimeSeriesSlice &slice) {
     std::stringstream ss{};
 
     // If we need to write more than one char for a given point then successive
@@ -220,10 +275,10 @@ Formatter::format_xaxis_per_hour(std::vector<TimePoint> points) {
 
     int num_chars_after_this_one{-1};
 
-    for (std::size_t i = 0; i < points.size(); i++) {
-        num_chars_after_this_one = points.size() - 1 - i;
+    for (std::size_t i = 0; i < slice.size(); i++) {
+        num_chars_after_this_one = slice.size() - 1 - i;
 
-        auto tp = points[i];
+        auto tp = slice.time_point(i);
         int hours = time_keeping_.get_hours(tp);
 
         if (chars_to_skip > 0) {
@@ -249,7 +304,8 @@ Formatter::format_xaxis_per_hour(std::vector<TimePoint> points) {
     return FormattedString{ss.str()};
 }
 
-FormattedString Formatter::format_xaxis_per_day(std::vector<TimePoint> points) {
+FormattedString
+Formatter::format_xaxis_per_day(const TimeSeriesSlice &slice) {
     std::stringstream ss{};
 
     // If we need to write more than one char for a given point then successive
@@ -259,10 +315,10 @@ FormattedString Formatter::format_xaxis_per_day(std::vector<TimePoint> points) {
 
     int num_chars_after_this_one{-1};
 
-    for (std::size_t i = 0; i < points.size(); i++) {
-        num_chars_after_this_one = points.size() - 1 - i;
+    for (std::size_t i = 0; i < slice.size(); i++) {
+        num_chars_after_this_one = slice.size() - 1 - i;
 
-        auto tp = points[i];
+        auto tp = slice.time_point(i);
         int day = time_keeping_.get_wday(tp);
 
         if (chars_to_skip > 0) {
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "aliases.hpp"
+#include "sampling/time_series_slice.hpp"
 #include "termui/yaxis_scale.hpp"
 #include "tools/time_keeping.hpp"
 
@@ -26,6 +27,8 @@ class FormattedString {
 };
 
 class Formatter {
+    using TimeSeriesSlice = sampling::TimeSeriesSlice;
+
   public:
     std::string format_decimal(uint64_t int_part, uint64_t dec_part,
                                const std::string &unit);
@@ -33,10 +36,12 @@ class Formatter {
     std::string format_num_bytes_rate(YAxisScale scale, uint64_t num,
                                       const std::string &time_unit);
 
-    FormattedString format_xaxis_per_sec(std::vector<TimePoint> points);
-    FormattedString format_xaxis_per_min(std::vector<TimePoint> points);
-    FormattedString format_xaxis_per_hour(std::vector<TimePoint> points);
-    FormattedString format_xaxis_per_day(std::vector<TimePoint> points);
+    // one char per bucket of the slice
+    FormattedString format_xaxis_per_subsec(const TimeSeriesSlice &slice);
+    FormattedString format_xaxis_per_sec(const TimeSeriesSlice &slice);
+    FormattedString format_xaxis_per_min(const TimeSeriesSlice &slice);
+    FormattedString format_xaxis_per_hour(const TimeSeriesSlice &slice);
+    FormattedString format_xaxis_per_day(const TimeSeriesSlice &slice);
 
     std::string format_Day(TimePoint tp);
     std::string format_HH_MM(TimePoint tp);
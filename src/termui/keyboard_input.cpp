@@ -1,75 +1,122 @@
 #include <cstdio>
-#include <cstring>
-#include <thread>
 
 #include "keyboard_input.hpp"
+#include "macros.hpp"
 
 namespace bandwit {
 namespace termui {
 
-KeyPress KeyboardInputReader::read_keypress(Millis interval) {
-    KeyPress key{KeyPress::NOTHING};
-
-    // Sleep first to give the user time to press a key
-    std::this_thread::sleep_for(interval);
+void KeyboardInputReader::read_available() {
+    int ch = fgetc(fl_);
+    while (ch != EOF) {
+        decode(U8(ch));
+        ch = fgetc(fl_);
+    }
 
-    // Read the key press non blocking
-    char chars[4096] = {0};
-    int i = 0;
+    // There's no more for now, which isn't the end of the input.
+    clearerr(fl_);
+}
 
-    char ch = fgetc(fl_);
-    while (ch >= 0) {
-        chars[i++] = ch;
-        ch = fgetc(fl_);
+void KeyboardInputReader::feed(const std::string &input) {
+    for (auto ch : input) {
+        decode(U8(ch));
     }
+}
 
-    if ((strlen(chars) == 1) && (chars[0] == '\n')) {
-        key = KeyPress::CARRIAGE_RETURN;
-    } else if ((strlen(chars) == 1) && (chars[0] == 'r')) {
-        key = KeyPress::LETTER_R;
-    } else if ((strlen(chars) == 1) && (chars[0] == 't')) {
-        key = KeyPress::LETTER_T;
-    } else if ((strlen(chars) == 1) && (chars[0] == 'c')) {
-        key = KeyPress::LETTER_C;
-    } else if ((strlen(chars) == 1) && (chars[0] == 's')) {
-        key = KeyPress::LETTER_S;
-    } else if ((strlen(chars) == 1) && (chars[0] == 'q')) {
-        key = KeyPress::QUIT;
-    } else if ((strlen(chars) == 3) && (chars[0] == '\033') &&
-               chars[2] == 'A') {
-        key = KeyPress::ARROW_UP;
-    } else if ((strlen(chars) == 3) && (chars[0] == '\033') &&
-               chars[2] == 'B') {
-        key = KeyPress::ARROW_DOWN;
-    } else if ((strlen(chars) == 3) && (chars[0] == '\033') &&
-               chars[2] == 'C') {
-        key = KeyPress::ARROW_RIGHT;
-    } else if ((strlen(chars) == 3) && (chars[0] == '\033') &&
-               chars[2] == 'D') {
-        key = KeyPress::ARROW_LEFT;
+bool KeyboardInputReader::pop(KeyPress &key) {
+    if (keys_.empty()) {
+        return false;
     }
-    return key;
+
+    key = keys_.front();
+    keys_.pop_front();
+    return true;
 }
 
-KeyPress KeyboardInputReader::read_nonblocking(Millis interval) {
-    // We have `interval` of time in which to read a key press. Once we read it
-    // we immediately return it. If there is no input we keep spinning and
-    // trying again.
-    auto num_loops = interval / read_char_interval_;
-    auto frac_read_interval = interval - (num_loops * read_char_interval_);
+void KeyboardInputReader::decode(uint8_t byte) {
+    switch (state_) {
+    case DecoderState::GROUND:
+        decode_ground(byte);
+        break;
 
-    // spin for num_loops + 1 and use the fractional interval in one of the
-    // loops
-    for (auto i = 0; i < num_loops + 1; i++) {
-        auto sleep = i == 0 ? frac_read_interval : read_char_interval_;
+    case DecoderState::ESCAPE:
+        if ((byte == '[') || (byte == 'O')) {
+            // arrow keys are ESC[A, or ESC OA in application mode
+            state_ = DecoderState::SEQUENCE;
+        } else {
+            // the escape key on its own, which we have no use for
+            state_ = DecoderState::GROUND;
+            decode_ground(byte);
+        }
+        break;
 
-        auto key = read_keypress(sleep);
-        if (key != KeyPress::NOTHING) {
-            return key;
+    case DecoderState::SEQUENCE:
+        // parameters and intermediates, eg. the 1;5 of ESC[1;5A, come before
+        // the final byte
+        if ((byte >= 0x20) && (byte <= 0x3f)) {
+            break;
+        }
+        state_ = DecoderState::GROUND;
+        if (byte < 0x20) {
+            // a control char cuts the sequence short, eg. the ESC of the next
+            // one
+            decode_ground(byte);
+        } else {
+            decode_sequence_end(byte);
         }
+        break;
     }
+}
 
-    return KeyPress::NOTHING;
+void KeyboardInputReader::decode_ground(uint8_t byte) {
+    switch (byte) {
+    case '\033':
+        state_ = DecoderState::ESCAPE;
+        break;
+    case '\n':
+        keys_.push_back(KeyPress::CARRIAGE_RETURN);
+        break;
+    case 'r':
+        keys_.push_back(KeyPress::LETTER_R);
+        break;
+    case 't':
+        keys_.push_back(KeyPress::LETTER_T);
+        break;
+    case 'c':
+        keys_.push_back(KeyPress::LETTER_C);
+        break;
+    case 's':
+        keys_.push_back(KeyPress::LETTER_S);
+        break;
+    case 'i':
+        keys_.push_back(KeyPress::LETTER_I);
+        break;
+    case 'q':
+        keys_.push_back(KeyPress::QUIT);
+        break;
+    default:
+        break;
+    }
+}
+
+void KeyboardInputReader::decode_sequence_end(uint8_t byte) {
+    switch (byte) {
+    case 'A':
+        keys_.push_back(KeyPress::ARROW_UP);
+        break;
+    case 'B':
+        keys_.push_back(KeyPress::ARROW_DOWN);
+        break;
+    case 'C':
+        keys_.push_back(KeyPress::ARROW_RIGHT);
+        break;
+    case 'D':
+        keys_.push_back(KeyPress::ARROW_LEFT);
+        break;
+    default:
+        // a key we don't use, eg. F1
+        break;
+    }
 }
 
 } // namespace termui
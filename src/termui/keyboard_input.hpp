@@ -2,11 +2,9 @@
 #define KEYBOARD_INPUT_H
 
 #include <cstdint>
-#include <map>
+#include <cstdio>
+#include <deque>
 #include <string>
-#include <vector>
-
-#include "aliases.hpp"
 
 namespace bandwit {
 namespace termui {
@@ -18,6 +16,7 @@ enum class KeyPress {
     LETTER_T,
     LETTER_C,
     LETTER_S,
+    LETTER_I,
     ARROW_UP,
     ARROW_DOWN,
     ARROW_LEFT,
@@ -25,20 +24,40 @@ enum class KeyPress {
     QUIT,
 };
 
+// Turns the bytes typed (or pasted) into key presses. Every key in the input
+// is kept, however many arrive at once, and an escape sequence may be split
+// across reads.
 class KeyboardInputReader {
   public:
     explicit KeyboardInputReader(FILE *fl) : fl_{fl} {}
 
-    KeyPress read_nonblocking(Millis interval);
+    // Reads what is in `fl`, which has to be non-blocking, without waiting
+    // for more, and queues the keys in it.
+    void read_available();
+    // for input that was read elsewhere, it goes before anything read next
+    void feed(const std::string &input);
+
+    // Returns false if there are no more keys.
+    bool pop(KeyPress &key);
 
   private:
-    KeyPress read_keypress(Millis interval);
+    enum class DecoderState {
+        GROUND,
+        // after ESC
+        ESCAPE,
+        // after ESC[ or ESC O, until the final byte of the sequence
+        SEQUENCE,
+    };
+
+    void decode(uint8_t byte);
+    void decode_ground(uint8_t byte);
+    void decode_sequence_end(uint8_t byte);
 
     // Where to read the char from
     FILE *fl_;
 
-    // How much time to allow for a single key press
-    Millis read_char_interval_{10};
+    DecoderState state_{DecoderState::GROUND};
+    std::deque<KeyPress> keys_{};
 };
 
 } // namespace termui
@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <poll.h>
 #include <stdexcept>
 #include <sys/ioctl.h>
+#include <unistd.h>
 
 #include "except.hpp"
 #include "file_status.hpp"
@@ -8,6 +13,9 @@
 namespace bandwit {
 namespace termui {
 
+static const std::string sync_output_begin{"\033[?2026h"};
+static const std::string sync_output_end{"\033[?2026l"};
+
 Dimensions TerminalDriver::get_terminal_size() {
     struct winsize size {};
     int stdout_fileno = fileno(stdout_file_);
@@ -31,7 +39,8 @@ Point TerminalDriver::get_cursor_position() {
     // observe (window resizing).
     // If we did fail to read the cursor pos on startup we could fall back on
     // taking over the whole terminal window...
-    fprintf(stdout_file_, "\033[6n");
+    frame_ += "\033[6n";
+    flush_output();
 
     int cur_x, cur_y;
     if (fscanf(stdin_file_, "\033[%d;%dR", &cur_y, &cur_x) < 2) {
@@ -43,27 +52,200 @@ Point TerminalDriver::get_cursor_position() {
     return pt;
 }
 
-void TerminalDriver::set_cursor_position(const Point &pt) {
-    fprintf(stdout_file_, "\033[%d;%dH", pt.y, pt.x);
+void TerminalDriver::detect_synchronized_output() {
+    // Terminals that don't know DECRQM (ESC[?2026$p) don't answer it at all,
+    // so we ask for the cursor position right after it. Every terminal answers
+    // that, and in order, so its answer tells us that we have seen all there
+    // is to see. Should it not come we take it that there's no synchronized
+    // output either.
+    frame_ += "\033[?2026$p\033[6n";
+    flush_output();
+
+    auto deadline = std::chrono::steady_clock::now() + reply_timeout_;
+
+    std::string input{};
+    auto cursor_pos = find_reply(input, "\033[", 'R');
+    while (!cursor_pos.has_value()) {
+        auto remaining = std::chrono::ceil<Millis>(
+            deadline - std::chrono::steady_clock::now());
+        if ((remaining <= Millis{0}) || !read_with_timeout(input, remaining)) {
+            break;
+        }
+        cursor_pos = find_reply(input, "\033[", 'R');
+    }
+
+    if (cursor_pos.has_value()) {
+        auto end = input.find('R', cursor_pos.value());
+        input.erase(cursor_pos.value(), end + 1 - cursor_pos.value());
+    }
+
+    // ESC[?2026;<n>$y, where 1 and 2 are set and reset, 0 is an unknown mode
+    // and 3 and 4 are permanently set and reset
+    auto mode_pos = find_reply(input, "\033[?2026;", '$');
+    if (mode_pos.has_value()) {
+        auto pos = mode_pos.value();
+        auto end = input.find('$', pos);
+        auto value = input.substr(pos + 8, end - pos - 8);
+        sync_output_ = (value == "1") || (value == "2");
+
+        // and the y after the $
+        input.erase(pos, std::min(end + 2, input.size()) - pos);
+    }
+
+    // anything else was typed by the user
+    pending_input_ += input;
+}
+
+std::string TerminalDriver::take_pending_input() {
+    std::string input{};
+    input.swap(pending_input_);
+    return input;
 }
 
-void TerminalDriver::put_char(const char &ch) {
-    char_str_[0] = ch;
-    fprintf(stdout_file_, "%s", char_str_);
+void TerminalDriver::set_cursor_position(const Point &pt) {
+    frame_ += "\033[";
+    append_number(pt.y);
+    frame_ += ';';
+    append_number(pt.x);
+    frame_ += 'H';
 }
 
+void TerminalDriver::put_char(const char &ch) { frame_ += ch; }
+
 void TerminalDriver::put_uchar(const std::string &ch) {
     // We can't really validate ch by checking the length or anything, it can be
     // any sequence of bytes that make up a char. It's supposed to be only one
     // char.
-    fprintf(stdout_file_, "%s", ch.c_str());
+    frame_ += ch;
 }
 
-void TerminalDriver::put_string(const std::string &str) {
-    fprintf(stdout_file_, "%s", str.c_str());
+void TerminalDriver::put_string(const std::string &str) { frame_ += str; }
+
+void TerminalDriver::flush_output() {
+    if (frame_.empty()) {
+        return;
+    }
+
+    // the const_casts are for iovec, writev() doesn't modify the buffers
+    iovec iov[3] = {
+        {const_cast<char *>(sync_output_begin.data()), sync_output_begin.size()},
+        {frame_.data(), frame_.size()},
+        {const_cast<char *>(sync_output_end.data()), sync_output_end.size()},
+    };
+
+    if (sync_output_) {
+        write_all(iov, 3);
+    } else {
+        write_all(iov + 1, 1);
+    }
+
+    // keeps its capacity, so that the next frame doesn't allocate
+    frame_.clear();
 }
 
-void TerminalDriver::flush_output() { fflush(stdout_file_); }
+void TerminalDriver::append_number(uint16_t num) {
+    char digits[5];
+    int len = 0;
+    do {
+        digits[len++] = static_cast<char>('0' + num % 10);
+        num /= 10;
+    } while (num > 0);
+
+    while (len > 0) {
+        frame_ += digits[--len];
+    }
+}
+
+void TerminalDriver::write_all(iovec *iov, int iovcnt) {
+    int fd = fileno(stdout_file_);
+
+    while (iovcnt > 0) {
+        ssize_t written = writev(fd, iov, iovcnt);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // stdout shares its file status with stdin when both are the
+            // terminal, so it may well be non-blocking
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+                pollfd pfd{fd, POLLOUT, 0};
+                poll(&pfd, 1, -1);
+                continue;
+            }
+            THROW_CERROR(std::runtime_error,
+                         "TerminalDriver.write_all failed in writev()");
+        }
+
+        // skip what was written, which may end part way through a buffer
+        auto remaining = SIZE_T(written);
+        while ((iovcnt > 0) && (remaining >= iov->iov_len)) {
+            remaining -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+}
+
+bool TerminalDriver::read_with_timeout(std::string &input, Millis timeout) {
+    int fd = fileno(stdin_file_);
+
+    pollfd pfd{fd, POLLIN, 0};
+    int rv = poll(&pfd, 1, INT(timeout.count()));
+    if (rv < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        THROW_CERROR(std::runtime_error,
+                     "TerminalDriver.read_with_timeout failed in poll()");
+    }
+    if (rv == 0) {
+        return false;
+    }
+
+    char buf[256];
+    ssize_t nread = read(fd, buf, sizeof(buf));
+    if (nread < 0) {
+        if ((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return true;
+        }
+        THROW_CERROR(std::runtime_error,
+                     "TerminalDriver.read_with_timeout failed in read()");
+    }
+    if (nread == 0) {
+        // end of input, there's no answer coming
+        return false;
+    }
+
+    input.append(buf, SIZE_T(nread));
+    return true;
+}
+
+std::optional<std::size_t>
+TerminalDriver::find_reply(const std::string &input, const std::string &prefix,
+                           char final) {
+    auto pos = input.find(prefix);
+    while (pos != std::string::npos) {
+        auto i = pos + prefix.size();
+        auto first = i;
+        while ((i < input.size()) &&
+               (((input[i] >= '0') && (input[i] <= '9')) || (input[i] == ';'))) {
+            ++i;
+        }
+
+        if ((i > first) && (i < input.size()) && (input[i] == final)) {
+            return pos;
+        }
+
+        pos = input.find(prefix, pos + 1);
+    }
+
+    return std::nullopt;
+}
 
 } // namespace termui
-} // namespace bandwit
\ No newline at end of file
+} // namespace bandwit
@@ -2,7 +2,11 @@
 #define TERMINAL_DRIVER_H
 
 #include <iostream>
+#include <optional>
+#include <string>
+#include <sys/uio.h>
 
+#include "aliases.hpp"
 #include "macros.hpp"
 #include "termui/dimensions.hpp"
 #include "termui/point.hpp"
@@ -21,6 +25,14 @@ class TerminalDriver {
 
     Dimensions get_terminal_size();
     Point get_cursor_position();
+    // asks the terminal whether it can hold off painting until a frame is
+    // complete (DEC private mode 2026), and wraps every frame in it if so
+    void detect_synchronized_output();
+    // what was typed while we were waiting for the terminal to answer, for
+    // the keyboard input to go through
+    std::string take_pending_input();
+
+    // these collect the frame, flush_output() sends it in a single write
     void set_cursor_position(const Point &pt);
     void put_char(const char &ch);
     void put_uchar(const std::string &ch);
@@ -28,13 +40,26 @@ class TerminalDriver {
     void flush_output();
 
   private:
+    void append_number(uint16_t num);
+    void write_all(iovec *iov, int iovcnt);
+    bool read_with_timeout(std::string &input, Millis timeout);
+
+    // ESC[ `prefix`, then digits and semicolons, then `final`
+    static std::optional<std::size_t> find_reply(const std::string &input,
+                                                 const std::string &prefix,
+                                                 char final);
+
     FILE *stdin_file_{};
     FILE *stdout_file_{};
 
     FileStatusSetter *status_setter_{nullptr};
 
-    // we need a one char null terminated string
-    char char_str_[2] = {0};
+    // how long we give the terminal to answer a query
+    Millis reply_timeout_{100};
+
+    bool sync_output_{false};
+    std::string frame_{};
+    std::string pending_input_{};
 };
 
 } // namespace termui
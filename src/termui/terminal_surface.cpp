@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 #include "except.hpp"
@@ -8,6 +11,14 @@
 namespace bandwit {
 namespace termui {
 
+// Moving the cursor takes an escape sequence of about 8 bytes, so a few cells
+// that haven't changed between two that have are sent again instead.
+static constexpr uint16_t max_run_gap = 3;
+
+// Shifting a row takes a cursor move and a DCH or ICH sequence, which is about
+// what sending a couple of cells that changed costs.
+static constexpr std::size_t shift_cost = 2;
+
 TerminalSurface::TerminalSurface(TerminalWindow *win, uint16_t num_lines)
     : win_{win}, num_lines_{num_lines} {
     win_->register_resize_receiver(this);
@@ -50,7 +61,9 @@ void TerminalSurface::on_startup() {
     upper_left_ = Point{win_cur.x, upper_left_y};
     lower_left_ = recompute_lower_left(upper_left_);
 
-    clear_surface();
+    // nothing we know of is on the terminal yet, so this blanks the surface
+    reset_buffers();
+    flush();
 }
 
 void TerminalSurface::on_window_resize(const Dimensions &win_dim_old,
@@ -85,7 +98,9 @@ void TerminalSurface::on_window_resize(const Dimensions &win_dim_old,
     lower_left_ = recompute_lower_left(upper_left_);
     dim_ = recompute_dimensions(win_dim_new);
 
-    clear_surface();
+    // The terminal may have reflowed the lines, we can't tell what's on it.
+    // The next flush repaints the whole surface.
+    reset_buffers();
 
     // Notify our receiver
     if (resize_receiver_ != nullptr) {
@@ -124,47 +139,128 @@ void TerminalSurface::on_carriage_return() {
         upper_left_.y -= 1;
     }
     lower_left_ = recompute_lower_left(upper_left_);
+
+    // the scroll moved whatever was on the surface
+    reset_buffers();
 }
 
 void TerminalSurface::clear_surface() {
-    auto dim = get_size();
-    auto upper_left = get_upper_left();
-    auto lower_left = get_lower_left();
-
-    win_->set_cursor(upper_left);
-
-    for (int y = 0; y < num_lines_; ++y) {
-        for (int x = 1; x <= dim.width; ++x) {
-            win_->put_char(bg_char_);
-        }
-    }
-
-    win_->set_cursor(lower_left);
-    win_->flush();
+    Cell bg_cell{{bg_char_, 0, 0, 0}, 1, 0};
+    std::fill(back_.begin(), back_.end(), bg_cell);
 }
 
 void TerminalSurface::put_char(const Point &point, const char &ch) {
-    auto point_win = translate_point(point);
-
-    win_->set_cursor(point_win);
-    win_->put_char(ch);
+    put_glyph(point, &ch, 1, 0);
 }
 
 void TerminalSurface::put_uchar(const Point &point, const std::string &ch) {
-    auto point_win = translate_point(point);
-
-    win_->set_cursor(point_win);
-    win_->put_uchar(ch);
+    put_glyph(point, ch.data(), ch.size(), 0);
 }
 
 void TerminalSurface::put_string(const Point &point, const std::string &str) {
-    auto point_win = translate_point(point);
+    Point cur = point;
+    uint8_t attrs = 0;
+    std::size_t i = 0;
+
+    while (i < str.size()) {
+        auto byte = static_cast<unsigned char>(str[i]);
+
+        if ((byte == '\033') && (i + 1 < str.size()) && (str[i + 1] == '[')) {
+            // An SGR sequence, eg. ESC[7m, sets the attributes of the glyphs
+            // after it. Its parameters are separated by ';'.
+            int param = 0;
+            for (i += 2; i < str.size(); ++i) {
+                char ch = str[i];
+                if ((ch >= '0') && (ch <= '9')) {
+                    param = param * 10 + (ch - '0');
+                    continue;
+                }
+
+                if (param == 0) {
+                    attrs = 0;
+                } else if (param == 1) {
+                    attrs |= attr_bold;
+                } else if (param == 7) {
+                    attrs |= attr_reverse_video;
+                }
+                param = 0;
+
+                if (ch != ';') {
+                    break;
+                }
+            }
+            ++i;
+            continue;
+        }
+
+        // the lead byte of a UTF-8 sequence tells its length
+        std::size_t len = 1;
+        if (byte >= 0xf0) {
+            len = 4;
+        } else if (byte >= 0xe0) {
+            len = 3;
+        } else if (byte >= 0xc0) {
+            len = 2;
+        }
+        len = std::min(len, str.size() - i);
 
-    win_->set_cursor(point_win);
-    win_->put_string(str);
+        put_glyph(cur, str.data() + i, len, attrs);
+        ++cur.x;
+        i += len;
+    }
+}
+
+void TerminalSurface::shift_columns(uint16_t x_from, uint16_t y_from,
+                                    uint16_t y_to, int columns) {
+    shift_ = Shift{true, x_from, y_from, y_to, columns};
 }
 
 void TerminalSurface::flush() {
+    auto width = dim_.width;
+    uint8_t attrs = 0;
+
+    if (shift_.is_pending) {
+        apply_shift();
+    }
+
+    for (uint16_t y = 1; y <= num_lines_; ++y) {
+        auto *front = front_.data() + SIZE_T(y - 1) * width;
+        const auto *back = back_.data() + SIZE_T(y - 1) * width;
+
+        uint16_t x = 1;
+        while (x <= width) {
+            if (front[x - 1] == back[x - 1]) {
+                ++x;
+                continue;
+            }
+
+            // The run goes on to the last cell that changed, as long as no
+            // more than max_run_gap unchanged ones are in between.
+            uint16_t end = x + 1;
+            for (uint16_t next = x + 1;
+                 (next <= width) && (next - end <= max_run_gap); ++next) {
+                if (front[next - 1] != back[next - 1]) {
+                    end = next + 1;
+                }
+            }
+
+            run_.clear();
+            for (auto i = x; i < end; ++i) {
+                append_cell(back[i - 1], attrs);
+                front[i - 1] = back[i - 1];
+            }
+
+            win_->set_cursor(translate_point(Point{x, y}));
+            win_->put_string(run_);
+
+            x = end;
+        }
+    }
+
+    if (attrs != 0) {
+        win_->put_string("\033[0m");
+    }
+
     auto lower_left = get_lower_left();
     win_->set_cursor(lower_left);
 
@@ -181,6 +277,117 @@ void TerminalSurface::register_resize_receiver(WindowResizeReceiver *receiver) {
     resize_receiver_ = receiver;
 }
 
+bool TerminalSurface::Cell::operator==(const Cell &other) const {
+    return (len == other.len) && (attrs == other.attrs) &&
+           (glyph == other.glyph);
+}
+
+bool TerminalSurface::Cell::operator!=(const Cell &other) const {
+    return !(*this == other);
+}
+
+void TerminalSurface::reset_buffers() {
+    auto size = SIZE_T(dim_.width) * SIZE_T(num_lines_);
+
+    // A cell without a glyph never equals one that has one, so every cell is
+    // sent on the next flush.
+    front_.assign(size, Cell{{0, 0, 0, 0}, 0, 0});
+    back_.resize(size);
+    clear_surface();
+
+    // there is nothing on the terminal to shift
+    shift_.is_pending = false;
+}
+
+void TerminalSurface::apply_shift() {
+    shift_.is_pending = false;
+
+    auto width = dim_.width;
+    auto x_from = std::max(shift_.x_from, U16(1));
+    auto y_to = std::min(shift_.y_to, num_lines_);
+    if ((x_from > width) || (shift_.columns == 0)) {
+        return;
+    }
+    auto len = SIZE_T(width - x_from + 1);
+
+    for (auto y = std::max(shift_.y_from, U16(1)); y <= y_to; ++y) {
+        auto *front = front_.data() + SIZE_T(y - 1) * width + (x_from - 1);
+        const auto *back = back_.data() + SIZE_T(y - 1) * width + (x_from - 1);
+
+        shifted_.assign(front, front + len);
+        shift_row(shifted_.data(), len, shift_.columns);
+
+        std::size_t changed = 0;
+        std::size_t changed_shifted = 0;
+        for (std::size_t i = 0; i < len; ++i) {
+            changed += (front[i] != back[i]) ? 1 : 0;
+            changed_shifted += (shifted_[i] != back[i]) ? 1 : 0;
+        }
+
+        if (changed_shifted + shift_cost >= changed) {
+            continue;
+        }
+
+        // DCH deletes cells at the cursor and ICH inserts blank ones, the
+        // rest of the line up to the right edge moves along
+        auto num = std::to_string(std::abs(shift_.columns));
+        win_->set_cursor(translate_point(Point{x_from, y}));
+        win_->put_string("\033[" + num + (shift_.columns < 0 ? "P" : "@"));
+
+        std::copy(shifted_.begin(), shifted_.end(), front);
+    }
+}
+
+void TerminalSurface::shift_row(Cell *row, std::size_t len, int columns) {
+    Cell blank{{bg_char_, 0, 0, 0}, 1, 0};
+    auto num = std::min(SIZE_T(std::abs(columns)), len);
+
+    if (columns < 0) {
+        std::copy(row + num, row + len, row);
+        std::fill(row + len - num, row + len, blank);
+    } else {
+        std::copy_backward(row, row + len - num, row + len);
+        std::fill(row, row + num, blank);
+    }
+}
+
+TerminalSurface::Cell *TerminalSurface::get_cell(const Point &point) {
+    if ((point.x < 1) || (point.x > dim_.width) || (point.y < 1) ||
+        (point.y > num_lines_)) {
+        return nullptr;
+    }
+    return &back_[SIZE_T(point.y - 1) * dim_.width + (point.x - 1)];
+}
+
+void TerminalSurface::put_glyph(const Point &point, const char *glyph,
+                                std::size_t len, uint8_t attrs) {
+    // whatever doesn't fit on the surface is cut off
+    Cell *cell = get_cell(point);
+    if ((cell == nullptr) || (len == 0) || (len > cell->glyph.size())) {
+        return;
+    }
+
+    cell->glyph.fill(0);
+    memcpy(cell->glyph.data(), glyph, len);
+    cell->len = U8(len);
+    cell->attrs = attrs;
+}
+
+void TerminalSurface::append_cell(const Cell &cell, uint8_t &attrs) {
+    if (cell.attrs != attrs) {
+        run_ += "\033[0m";
+        if ((cell.attrs & attr_bold) != 0) {
+            run_ += "\033[1m";
+        }
+        if ((cell.attrs & attr_reverse_video) != 0) {
+            run_ += "\033[7m";
+        }
+        attrs = cell.attrs;
+    }
+
+    run_.append(cell.glyph.data(), cell.len);
+}
+
 void TerminalSurface::check_surface_fits(const Dimensions &win_dim) {
     if ((win_dim.width < min_cols_) || (win_dim.height < min_lines_)) {
         THROW_ARGS(std::runtime_error,
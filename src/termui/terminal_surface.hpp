@@ -1,6 +1,10 @@
 #ifndef TERMINAL_SURFACE_H
 #define TERMINAL_SURFACE_H
 
+#include <array>
+#include <string>
+#include <vector>
+
 #include "termui/dimensions.hpp"
 #include "termui/point.hpp"
 #include "termui/window_resize.hpp"
@@ -10,6 +14,9 @@ namespace termui {
 
 class TerminalWindow;
 
+// Drawing goes into a back buffer of cells. flush() compares it with the front
+// buffer, which holds what the terminal shows, and only sends the cells that
+// differ.
 class TerminalSurface : public WindowResizeReceiver {
   public:
     TerminalSurface(TerminalWindow *win, uint16_t num_lines);
@@ -19,10 +26,17 @@ class TerminalSurface : public WindowResizeReceiver {
                           const Dimensions &win_dim_new) override;
     void on_carriage_return();
 
+    // these only draw into the back buffer, flush() puts it on the terminal
     void clear_surface();
     void put_char(const Point &point, const char &ch);
     void put_uchar(const Point &point, const std::string &ch);
     void put_string(const Point &point, const std::string &str);
+    // A hint that what is drawn next in rows `y_from` to `y_to`, from column
+    // `x_from` to the right edge, is mostly what's there now moved by
+    // `columns`, to the right if positive. flush() then shifts the rows on
+    // the terminal where that saves sending cells.
+    void shift_columns(uint16_t x_from, uint16_t y_from, uint16_t y_to,
+                       int columns);
     void flush();
 
     const Dimensions &get_size() const;
@@ -32,6 +46,36 @@ class TerminalSurface : public WindowResizeReceiver {
     void register_resize_receiver(WindowResizeReceiver *receiver);
 
   private:
+    // text attributes, set by the SGR sequences in the strings we're given
+    static constexpr uint8_t attr_bold = 1;
+    static constexpr uint8_t attr_reverse_video = 2;
+
+    struct Cell {
+        // the UTF-8 encoding of a single glyph
+        std::array<char, 4> glyph;
+        uint8_t len;
+        uint8_t attrs;
+
+        bool operator==(const Cell &other) const;
+        bool operator!=(const Cell &other) const;
+    };
+
+    struct Shift {
+        bool is_pending;
+        uint16_t x_from;
+        uint16_t y_from;
+        uint16_t y_to;
+        int columns;
+    };
+
+    void reset_buffers();
+    void apply_shift();
+    void shift_row(Cell *row, std::size_t len, int columns);
+    Cell *get_cell(const Point &point);
+    void put_glyph(const Point &point, const char *glyph, std::size_t len,
+                   uint8_t attrs);
+    void append_cell(const Cell &cell, uint8_t &attrs);
+
     void check_surface_fits(const Dimensions &win_dim);
     Dimensions recompute_dimensions(const Dimensions &win_dim) const;
     Point recompute_lower_left(const Point &upper_left) const;
@@ -47,6 +91,16 @@ class TerminalSurface : public WindowResizeReceiver {
     uint16_t num_lines_{0};
     const char bg_char_ = ' ';
 
+    // indexed by (y - 1) * width + (x - 1)
+    std::vector<Cell> front_{};
+    std::vector<Cell> back_{};
+    // the glyphs of a flush that are sent in one go
+    std::string run_{};
+
+    Shift shift_{false, 0, 0, 0, 0};
+    // a row of the front buffer as it would be after the shift
+    std::vector<Cell> shifted_{};
+
     Dimensions dim_{};
     Point upper_left_{};
     Point lower_left_{};
@@ -1,8 +1,6 @@
-#include <csignal>
 #include <memory>
 
 #include "except.hpp"
-#include "signals.hpp"
 #include "terminal_driver.hpp"
 #include "terminal_surface.hpp"
 #include "terminal_window.hpp"
@@ -14,28 +12,17 @@ namespace termui {
 // TerminalWindow.
 static std::unique_ptr<TerminalWindow> WINDOW = nullptr;
 
-void TerminalWindow_signal_handler([[maybe_unused]] int sig) {
-    if (WINDOW == nullptr) {
-        THROW_MSG(std::runtime_error, "No TerminalWindow exists!");
-    }
-
-    WINDOW->on_resize();
-}
-
-TerminalWindow *TerminalWindow::create(TerminalDriver *driver,
-                                       SignalSuspender *signal_suspender) {
+TerminalWindow *TerminalWindow::create(TerminalDriver *driver) {
     if (WINDOW != nullptr) {
         THROW_MSG(std::runtime_error,
                   "Cannot construct another TerminalWindow!");
     }
 
-    WINDOW = std::make_unique<TerminalWindow>(driver, signal_suspender);
+    WINDOW = std::make_unique<TerminalWindow>(driver);
     return WINDOW.get();
 }
 
-TerminalWindow::TerminalWindow(TerminalDriver *driver,
-                               SignalSuspender *signal_suspender)
-    : driver_{driver}, signal_suspender_{signal_suspender} {
+TerminalWindow::TerminalWindow(TerminalDriver *driver) : driver_{driver} {
     // the window has to know its size at all times
     dim_ = driver_->get_terminal_size();
 
@@ -43,17 +30,13 @@ TerminalWindow::TerminalWindow(TerminalDriver *driver,
     // check cursor within dimensions?
     cursor_ = driver_->get_cursor_position();
 
-    // install handler to update size when it changes
-    install_resize_handler();
+    // and whether frames can be painted in one go
+    driver_->detect_synchronized_output();
 }
 
 TerminalWindow::~TerminalWindow() { WINDOW.release(); }
 
 void TerminalWindow::on_resize() {
-    // make sure we defer the next SIGWINCH while handling the current one
-    // because this function is not reentrant
-    SignalGuard guard{signal_suspender_};
-
     auto dim_new = driver_->get_terminal_size();
     auto dim_old = dim_;
     dim_ = dim_new;
@@ -129,9 +112,5 @@ void TerminalWindow::check_is_on_window(const Point &point) {
     }
 }
 
-void TerminalWindow::install_resize_handler() {
-    signal(SIGWINCH, TerminalWindow_signal_handler);
-}
-
 } // namespace termui
 } // namespace bandwit
\ No newline at end of file
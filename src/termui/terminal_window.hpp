@@ -9,22 +9,21 @@
 namespace bandwit {
 namespace termui {
 
-class SignalSuspender;
 class TerminalDriver;
 
 class TerminalWindow {
   public:
     // returns a non-owning pointer because the instance is owned by a static
     // unique_pointer
-    static TerminalWindow *create(TerminalDriver *driver,
-                                  SignalSuspender *signal_suspender);
+    static TerminalWindow *create(TerminalDriver *driver);
 
-    TerminalWindow(TerminalDriver *driver, SignalSuspender *signal_suspender);
+    explicit TerminalWindow(TerminalDriver *driver);
     ~TerminalWindow();
 
     CLASS_DISABLE_COPIES(TerminalWindow)
     CLASS_DISABLE_MOVES(TerminalWindow)
 
+    // to be called when the terminal was resized, ie. on SIGWINCH
     void on_resize();
 
     const Dimensions &get_size() const;
@@ -41,13 +40,10 @@ class TerminalWindow {
   private:
     void check_is_on_window(const Point &point);
 
-    void install_resize_handler();
-
     TerminalDriver *driver_{nullptr};
     Dimensions dim_{};
     Point cursor_{};
     WindowResizeReceiver *resize_receiver_{nullptr};
-    SignalSuspender *signal_suspender_{nullptr};
 };
 
 } // namespace termui
@@ -1,7 +1,14 @@
+#include <algorithm>
+#include <cerrno>
 #include <csignal>
 #include <fcntl.h>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#include "except.hpp"
 #include "sampling/sampler_detector.hpp"
 #include "termui.hpp"
 #include "termui/signals.hpp"
@@ -10,17 +17,41 @@
 namespace bandwit {
 namespace termui {
 
-TermUi::TermUi(const std::string &iface_name) : iface_name_{iface_name} {
+TermUi::TermUi(const std::string &iface_name, Millis interval,
+               const std::vector<sampling::Retention> &retentions,
+               const std::vector<AggregationWindow> &windows,
+               const std::optional<std::string> &data_dir)
+    : iface_name_{iface_name}, interval_{interval}, windows_{windows} {
     sampling::SamplerDetector detector{};
     auto det_result = detector.detect_sampler(iface_name);
 
-    sampler_ = std::move(det_result.sampler);
     prev_sample_ = det_result.sample;
+    sampling_thread_ = std::make_unique<sampling::SamplingThread>(
+        std::move(det_result.sampler), iface_name_, interval_);
+
+    if (windows_.empty()) {
+        for (const auto &retention : retentions) {
+            windows_.push_back(retention.window);
+        }
+    }
+    agg_window_ = windows_.front();
+
+    // Buckets are counted from the epoch rather than from when we started, so
+    // that history from earlier runs lines up with them.
+    TimePoint epoch{};
+    store_ = std::make_unique<InterfaceSeriesStore>(epoch, retentions);
+
+    if (data_dir.has_value()) {
+        if ((mkdir(data_dir->c_str(), 0755) < 0) && (errno != EEXIST)) {
+            THROW_ARGS(std::runtime_error, "failed to create directory: %s",
+                       data_dir->c_str());
+        }
+
+        store_->attach_files(data_dir.value() + "/" + iface_name_);
+    }
 
     susp_sigint_ =
         std::make_unique<SignalSuspender>(std::initializer_list<int>{SIGINT});
-    susp_sigwinch_ =
-        std::make_unique<SignalSuspender>(std::initializer_list<int>{SIGWINCH});
 
     TerminalModeSet mode_set{};
     interactive_mode_setter_ =
@@ -38,10 +69,10 @@ TermUi::TermUi(const std::string &iface_name) : iface_name_{iface_name} {
 
     terminal_driver_ = std::make_unique<TerminalDriver>(
         stdin, stdout, blocking_status_setter_.get());
-    TerminalWindow *terminal_window =
-        TerminalWindow::create(terminal_driver_.get(), susp_sigwinch_.get());
+    terminal_window_ = TerminalWindow::create(terminal_driver_.get());
 
-    terminal_surface_ = std::make_unique<TerminalSurface>(terminal_window, 12);
+    terminal_surface_ =
+        std::make_unique<TerminalSurface>(terminal_window_, 12);
     bar_chart_ = std::make_unique<BarChart>(terminal_surface_.get());
 
     FileStatusSet non_blocking_status_set{};
@@ -53,21 +84,16 @@ TermUi::TermUi(const std::string &iface_name) : iface_name_{iface_name} {
     non_blocking_status_setter_->set();
 
     kb_reader_ = std::make_unique<KeyboardInputReader>(stdin);
-
-    auto now = Clock::now();
-    const std::vector<AggregationWindow> windows{
-        AggregationWindow::ONE_SECOND,
-        AggregationWindow::ONE_MINUTE,
-        AggregationWindow::ONE_HOUR,
-        AggregationWindow::ONE_DAY,
-    };
-
-    ts_coll_rx_ = std::make_unique<TimeSeriesCollection>(now, windows);
-    ts_coll_tx_ = std::make_unique<TimeSeriesCollection>(now, windows);
+    // keys that were typed while we asked the terminal what it can do
+    kb_reader_->feed(terminal_driver_->take_pending_input());
 
     // tell the surface to notify us just after it's redrawn itself
     // following a window resize
     terminal_surface_->register_resize_receiver(this);
+
+    // From here on Ctrl+C and resizes are events. Before this Ctrl+C unwinds
+    // the stack.
+    event_loop_ = EventLoop::create(STDIN_FILENO);
 }
 
 TermUi::~TermUi() {
@@ -80,119 +106,309 @@ TermUi::~TermUi() {
 
 void TermUi::on_window_resize([[maybe_unused]] const Dimensions &win_dim_old,
                               [[maybe_unused]] const Dimensions &win_dim_new) {
-    render();
+    view_state_.mark_dirty(ViewChange::WINDOW_SIZE);
+
+    if (has_samples_) {
+        render();
+    }
 }
 
 void TermUi::run_forever() {
-    std::chrono::seconds one_sec{1};
+    // Sampling happens on its own thread, so it keeps to its schedule however
+    // long it takes us to render. It wakes us up when it has a sample.
+    sampling_thread_->start(event_loop_->get_sample_notifier());
+
+    // While the window is being resized we wait for it to settle before we
+    // lay out the surface and render again, once.
+    std::optional<std::chrono::steady_clock::time_point> resize_deadline{};
+
+    // the keys that were typed during startup
+    read_keyboard_input();
 
     while (true) {
-        // Time execution of sampling and rendering
-        auto pre = Clock::now();
+        std::optional<Millis> timeout{};
+        if (resize_deadline.has_value()) {
+            auto remaining = std::chrono::ceil<Millis>(
+                resize_deadline.value() - std::chrono::steady_clock::now());
+            timeout = std::max(remaining, Millis{0});
+        }
+
+        auto events = event_loop_->wait(timeout);
+
+        if (events.interrupt) {
+            throw InterruptException();
+        }
+
+        // whether we used to render a frame for what came in
+        bool frame_due = false;
+
+        if (events.samples) {
+            // what is on the screen, before the samples move the series on
+            bool at_newest = is_cursor_at_newest();
+            auto min_before = store_->min(agg_window_);
+
+            if (drain_samples()) {
+                // the first sample is taken right away, there is nothing to
+                // render before it arrives
+                has_samples_ = true;
+                frame_due = true;
+                sync_files();
+
+                // When we're scrolled back in time the samples are usually
+                // off to the right of what is shown. The instrumentation
+                // changes with every one though.
+                if (at_newest || show_status_ ||
+                    is_truncation_visible(min_before)) {
+                    view_state_.mark_dirty(ViewChange::DATA);
+                }
+            }
+        }
+
+        // Input only changes the view. It is rendered from what is stored
+        // already, the samples keep to the schedule of the sampling thread
+        // however many keys arrive.
+        if (events.input && read_keyboard_input()) {
+            frame_due = true;
+        }
+
+        if (events.resize) {
+            resize_deadline = std::chrono::steady_clock::now() + resize_settle_;
+        }
+
+        // The surface still has the size from before the resize, which may
+        // no longer fit on the window, so nothing is rendered until the
+        // resize is over. Laying it out again renders it.
+        if (resize_deadline.has_value()) {
+            if (std::chrono::steady_clock::now() >= resize_deadline.value()) {
+                resize_deadline.reset();
+                terminal_window_->on_resize();
+            }
+            continue;
+        }
+
+        if (!has_samples_) {
+            continue;
+        }
+
+        if (view_state_.is_dirty()) {
+            render();
+        } else if (frame_due) {
+            ++num_skipped_frames_;
+        }
+    }
+}
+
+bool TermUi::drain_samples() {
+    bool got_samples = false;
+
+    sampling::Sample sample{};
+    while (sampling_thread_->pop(sample)) {
+        add_sample(sample);
+        got_samples = true;
+    }
+
+    return got_samples;
+}
 
-        sample();
-        render_no_winch();
+bool TermUi::is_cursor_at_newest() const {
+    if (!scroll_cursor_.has_value()) {
+        return true;
+    }
+
+    // the newest bucket is the one that may still be receiving samples
+    return !store_->plus_one(agg_window_, scroll_cursor_.value()).has_value();
+}
+
+bool TermUi::is_truncation_visible(TimePoint min_before) const {
+    auto min_after = store_->min(agg_window_);
+    if (min_after == min_before) {
+        return false;
+    }
 
-        // Spend the rest of the second reading keyboard input
-        auto elapsed = Clock::now() - pre;
-        auto remaining = MILLIS(one_sec - elapsed);
+    if (!scroll_cursor_.has_value()) {
+        return true;
+    }
 
-        read_keyboard_input(remaining);
+    // The buckets that are dropped are the oldest ones, which are only shown
+    // if they are less than a width of the chart before the cursor.
+    auto interval = sampling::get_interval(agg_window_);
+    auto width = bar_chart_->get_width();
+    auto left_edge = scroll_cursor_.value() - interval * width;
+    return min_after > left_edge;
+}
+
+void TermUi::sync_files() {
+    auto now = Clock::now();
+    if (now - last_sync_ < sync_interval_) {
+        return;
     }
+
+    store_->sync_files();
+    last_sync_ = now;
 }
 
-void TermUi::sample() {
-    sampling::Sample sample = sampler_->get_sample(iface_name_);
+void TermUi::add_sample(const sampling::Sample &sample) {
+    // The sample carries the time its tick was scheduled for.
+    auto tp = sample.ts;
 
-    auto tp = Clock::from_time_t(sample.ts);
-    auto rx = sample.rx - prev_sample_.rx;
-    auto tx = sample.tx - prev_sample_.tx;
+    // The counters start over from zero when an interface is plugged back in,
+    // in which case everything we see is new traffic.
+    auto rx = sample.rx >= prev_sample_.rx ? sample.rx - prev_sample_.rx
+                                           : sample.rx;
+    auto tx = sample.tx >= prev_sample_.tx ? sample.tx - prev_sample_.tx
+                                           : sample.tx;
 
-    ts_coll_rx_->inc(tp, rx);
-    ts_coll_tx_->inc(tp, tx);
+    // The traffic of any ticks that were missed or dropped is included in the
+    // delta and ends up in the bucket of this sample.
+    sampling::MetricValues values{};
+    values[SIZE_T(Metric::RX_BYTES)] = rx;
+    values[SIZE_T(Metric::TX_BYTES)] = tx;
+    store_->inc(tp, values);
 
     prev_sample_ = sample;
 }
 
 void TermUi::render() {
-    // When we are called from `on_window_resize` the SIGWINCH signal guard is
-    // already in effect, so there is no need to use it here.
-    // Other callers of this function should suspend SIGWINCH before calling it.
-
     rescue_scroll_cursor();
 
     TimePoint cursor{};
     if (scroll_cursor_.has_value()) {
         cursor = scroll_cursor_.value();
     } else {
-        cursor = ts_coll_rx_->max(agg_window_);
+        cursor = store_->max(agg_window_);
     }
 
-    TimeSeriesSlice slice{};
     auto width = bar_chart_->get_width();
     std::string action{};
+    Metric metric{};
 
     if (display_mode_ == DisplayMode::DISPLAY_RX) {
         action = "received";
-        slice = ts_coll_rx_->get_slice_from_point(agg_window_, cursor, width,
-                                                  stat_mode_);
+        metric = Metric::RX_BYTES;
     } else {
         action = "transmitted";
-        slice = ts_coll_tx_->get_slice_from_point(agg_window_, cursor, width,
-                                                  stat_mode_);
+        metric = Metric::TX_BYTES;
+    }
+
+    store_->get_slice_from_point(metric, agg_window_, cursor, width,
+                                 stat_mode_, slice_);
+
+    std::string status{};
+    if (show_status_) {
+        status = format_status();
     }
 
-    bar_chart_->draw_bars_from_right(iface_name_, action, slice, display_scale_,
-                                     stat_mode_);
+    bar_chart_->draw_bars_from_right(iface_name_, action, slice_,
+                                     display_scale_, stat_mode_, status);
+    view_state_.mark_clean();
 }
 
-void TermUi::read_keyboard_input(Millis interval) {
-    KeyPress key = kb_reader_->read_nonblocking(interval);
+std::string TermUi::format_status() const {
+    auto stats = sampling_thread_->get_stats();
 
-    if (key == KeyPress::CARRIAGE_RETURN) {
-        // ignore SIGWINCH while we're acting on a resize
-        SignalGuard guard{susp_sigwinch_.get()};
+    auto to_millis = [](tools::Nanos nanos) {
+        return F64(nanos.count()) / 1000000.0;
+    };
+
+    std::stringstream ss{};
+    ss << std::fixed << std::setprecision(2);
+    ss << "[ticks " << stats.num_ticks << " missed " << stats.num_missed
+       << " dropped " << stats.num_dropped << " jitter "
+       << to_millis(stats.jitter_min) << "/" << to_millis(stats.jitter_mean)
+       << "/" << to_millis(stats.jitter_max) << "ms mem "
+       << store_->memory_usage() / 1024 << "KiB skipped "
+       << num_skipped_frames_ << " frames]";
+    return ss.str();
+}
+
+bool TermUi::read_keyboard_input() {
+    kb_reader_->read_available();
 
+    // every key that came in is applied, they are rendered together
+    bool got_keys = false;
+    KeyPress key{};
+    while (kb_reader_->pop(key)) {
+        apply_key(key);
+        got_keys = true;
+    }
+
+    return got_keys;
+}
+
+void TermUi::apply_key(KeyPress key) {
+    // Keys that leave the view as it is, like scrolling past either end, don't
+    // mark it dirty.
+    if (key == KeyPress::CARRIAGE_RETURN) {
         terminal_surface_->on_carriage_return();
+        view_state_.mark_dirty(ViewChange::WINDOW_SIZE);
 
     } else if (key == KeyPress::LETTER_R) {
-        display_mode_ = DisplayMode::DISPLAY_RX;
+        if (display_mode_ != DisplayMode::DISPLAY_RX) {
+            display_mode_ = DisplayMode::DISPLAY_RX;
+            view_state_.mark_dirty(ViewChange::MODE);
+        }
 
     } else if (key == KeyPress::LETTER_T) {
-        display_mode_ = DisplayMode::DISPLAY_TX;
+        if (display_mode_ != DisplayMode::DISPLAY_TX) {
+            display_mode_ = DisplayMode::DISPLAY_TX;
+            view_state_.mark_dirty(ViewChange::MODE);
+        }
 
     } else if (key == KeyPress::LETTER_C) {
         display_scale_ = next_scale(display_scale_);
+        view_state_.mark_dirty(ViewChange::SCALE);
 
     } else if (key == KeyPress::LETTER_S) {
-        if (stat_mode_ == Statistic::AVERAGE) {
-            stat_mode_ = Statistic::SUM;
-        } else if (stat_mode_ == Statistic::SUM) {
-            stat_mode_ = Statistic::AVERAGE;
-        }
+        stat_mode_ = sampling::next_statistic(stat_mode_);
+        view_state_.mark_dirty(ViewChange::STATISTIC);
+
+    } else if (key == KeyPress::LETTER_I) {
+        show_status_ = !show_status_;
+        view_state_.mark_dirty(ViewChange::MODE);
 
     } else if (key == KeyPress::ARROW_UP) {
-        agg_window_ = sampling::next_interval(agg_window_);
+        if (zoom_out()) {
+            view_state_.mark_dirty(ViewChange::CURSOR);
+        }
 
     } else if (key == KeyPress::ARROW_DOWN) {
-        agg_window_ = sampling::prev_interval(agg_window_);
+        if (zoom_in()) {
+            view_state_.mark_dirty(ViewChange::CURSOR);
+        }
 
     } else if (key == KeyPress::ARROW_LEFT) {
-        scroll_left();
+        if (scroll_left()) {
+            view_state_.mark_dirty(ViewChange::CURSOR);
+        }
 
     } else if (key == KeyPress::ARROW_RIGHT) {
-        scroll_right();
+        if (scroll_right()) {
+            view_state_.mark_dirty(ViewChange::CURSOR);
+        }
 
     } else if (key == KeyPress::QUIT) {
         throw InterruptException();
     }
 }
 
-void TermUi::render_no_winch() {
-    // ignore SIGWINCH while we're rendering
-    SignalGuard guard{susp_sigwinch_.get()};
+bool TermUi::zoom_out() {
+    auto it = std::find(windows_.begin(), windows_.end(), agg_window_);
+    if ((it != windows_.end()) && (it + 1 != windows_.end())) {
+        agg_window_ = *(it + 1);
+        return true;
+    }
+
+    return false;
+}
+
+bool TermUi::zoom_in() {
+    auto it = std::find(windows_.begin(), windows_.end(), agg_window_);
+    if ((it != windows_.end()) && (it != windows_.begin())) {
+        agg_window_ = *(it - 1);
+        return true;
+    }
 
-    render();
+    return false;
 }
 
 bool TermUi::scroll_left() {
@@ -202,10 +418,10 @@ bool TermUi::scroll_left() {
     if (scroll_cursor_.has_value()) {
         cursor = scroll_cursor_.value();
     } else {
-        cursor = ts_coll_rx_->max(agg_window_);
+        cursor = store_->max(agg_window_);
     }
 
-    auto opt_tp = ts_coll_rx_->minus_one(agg_window_, cursor);
+    auto opt_tp = store_->minus_one(agg_window_, cursor);
     if (opt_tp.has_value()) {
         scroll_cursor_.swap(opt_tp);
         cursor_moved = true;
@@ -221,15 +437,17 @@ bool TermUi::scroll_right() {
     if (scroll_cursor_.has_value()) {
         cursor = scroll_cursor_.value();
     } else {
-        cursor = ts_coll_rx_->max(agg_window_);
+        cursor = store_->max(agg_window_);
     }
 
-    auto opt_tp = ts_coll_rx_->plus_one(agg_window_, cursor);
+    auto opt_tp = store_->plus_one(agg_window_, cursor);
     if (opt_tp.has_value()) {
         scroll_cursor_.swap(opt_tp);
         cursor_moved = true;
-    } else {
+    } else if (scroll_cursor_.has_value()) {
+        // back to following the newest samples
         scroll_cursor_.reset();
+        cursor_moved = true;
     }
 
     return cursor_moved;
@@ -245,8 +463,8 @@ bool TermUi::rescue_scroll_cursor() {
     if (scroll_cursor_.has_value()) {
         auto cursor = scroll_cursor_.value();
 
-        auto min = ts_coll_rx_->min(agg_window_);
-        auto max = ts_coll_rx_->max(agg_window_);
+        auto min = store_->min(agg_window_);
+        auto max = store_->max(agg_window_);
 
         if (cursor < min) {
             scroll_cursor_.emplace(min);
@@ -6,17 +6,22 @@
 #include <string>
 
 #include "sampling/agg_window.hpp"
+#include "sampling/interface_series_store.hpp"
+#include "sampling/metric.hpp"
+#include "sampling/retention.hpp"
 #include "sampling/sampler.hpp"
+#include "sampling/sampling_thread.hpp"
 #include "sampling/statistic.hpp"
-#include "sampling/time_series_coll.hpp"
 #include "termui/bar_chart.hpp"
 #include "termui/display_mode.hpp"
 #include "termui/display_scale.hpp"
+#include "termui/event_loop.hpp"
 #include "termui/file_status.hpp"
 #include "termui/keyboard_input.hpp"
 #include "termui/terminal_driver.hpp"
 #include "termui/terminal_mode.hpp"
 #include "termui/terminal_surface.hpp"
+#include "termui/view_state.hpp"
 #include "termui/window_resize.hpp"
 
 namespace bandwit {
@@ -25,11 +30,18 @@ namespace termui {
 class TermUi : public WindowResizeReceiver {
     using AggregationWindow = sampling::AggregationWindow;
     using Statistic = sampling::Statistic;
-    using TimeSeriesCollection = sampling::TimeSeriesCollection;
+    using InterfaceSeriesStore = sampling::InterfaceSeriesStore;
+    using Metric = sampling::Metric;
     using TimeSeriesSlice = sampling::TimeSeriesSlice;
 
   public:
-    explicit TermUi(const std::string &iface_name);
+    // The arrow keys step through `windows`, or through the windows we keep a
+    // time series for if it is empty. If `data_dir` is set the history is
+    // kept in files in that directory.
+    TermUi(const std::string &iface_name, Millis interval,
+           const std::vector<sampling::Retention> &retentions,
+           const std::vector<AggregationWindow> &windows,
+           const std::optional<std::string> &data_dir);
     ~TermUi() override;
 
     CLASS_DISABLE_COPIES(TermUi)
@@ -41,11 +53,19 @@ class TermUi : public WindowResizeReceiver {
     void run_forever();
 
   private:
-    void sample();
+    bool drain_samples();
+    bool is_cursor_at_newest() const;
+    bool is_truncation_visible(TimePoint min_before) const;
+    void sync_files();
+    void add_sample(const sampling::Sample &sample);
     void render();
-    void read_keyboard_input(Millis interval);
+    bool read_keyboard_input();
+    void apply_key(KeyPress key);
 
-    void render_no_winch();
+    std::string format_status() const;
+
+    bool zoom_out();
+    bool zoom_in();
 
     bool scroll_left();
     bool scroll_right();
@@ -53,6 +73,21 @@ class TermUi : public WindowResizeReceiver {
 
     std::string iface_name_{};
 
+    // how often we sample
+    Millis interval_{1000};
+
+    // how long the window has to keep its size after a resize before we lay
+    // out the surface again, so that dragging its edge doesn't set off a
+    // render for every step
+    Millis resize_settle_{50};
+
+    // how often we ask for the history files to be written back
+    Millis sync_interval_{5000};
+    TimePoint last_sync_{};
+
+    // the aggregation windows the arrow keys step through, finest first
+    std::vector<AggregationWindow> windows_{};
+
     // Cursor is nullopt means we are in dynamic update mode.
     // Cursor is set means that we are scrolling to the left through historical
     // data.
@@ -63,21 +98,35 @@ class TermUi : public WindowResizeReceiver {
     Statistic stat_mode_{Statistic::AVERAGE};
     AggregationWindow agg_window_{AggregationWindow::ONE_SECOND};
 
+    // whether to show the sampling instrumentation
+    bool show_status_{false};
+
     sampling::Sample prev_sample_{};
+    bool has_samples_{false};
+
+    // what changed since the last frame
+    ViewState view_state_{};
+    // the samples and keys that came in without changing what is shown
+    uint64_t num_skipped_frames_{0};
+
+    // filled again for every frame
+    TimeSeriesSlice slice_{};
 
     std::unique_ptr<BarChart> bar_chart_{nullptr};
     std::unique_ptr<FileStatusSetter> blocking_status_setter_{nullptr};
     std::unique_ptr<FileStatusSetter> non_blocking_status_setter_{nullptr};
     std::unique_ptr<KeyboardInputReader> kb_reader_{nullptr};
     std::unique_ptr<SignalSuspender> susp_sigint_{nullptr};
-    std::unique_ptr<SignalSuspender> susp_sigwinch_{nullptr};
     std::unique_ptr<TerminalDriver> terminal_driver_{nullptr};
     std::unique_ptr<TerminalModeSetter> interactive_mode_setter_{nullptr};
+    // owned by a static unique_ptr, see TerminalWindow::create
+    TerminalWindow *terminal_window_{nullptr};
     std::unique_ptr<TerminalSurface> terminal_surface_{nullptr};
-    std::unique_ptr<sampling::Sampler> sampler_{nullptr};
+    // owned by a static unique_ptr, see EventLoop::create
+    EventLoop *event_loop_{nullptr};
+    std::unique_ptr<sampling::SamplingThread> sampling_thread_{nullptr};
 
-    std::unique_ptr<TimeSeriesCollection> ts_coll_rx_{nullptr};
-    std::unique_ptr<TimeSeriesCollection> ts_coll_tx_{nullptr};
+    std::unique_ptr<InterfaceSeriesStore> store_{nullptr};
 };
 
 } // namespace termui
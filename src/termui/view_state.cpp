@@ -0,0 +1,14 @@
+#include "termui/view_state.hpp"
+#include "macros.hpp"
+
+namespace bandwit {
+namespace termui {
+
+void ViewState::mark_dirty(ViewChange change) { dirty_ |= U8(change); }
+
+bool ViewState::is_dirty() const { return dirty_ != 0; }
+
+void ViewState::mark_clean() { dirty_ = 0; }
+
+} // namespace termui
+} // namespace bandwit
@@ -0,0 +1,22 @@
+#include <stdexcept>
+
+#include "divider.hpp"
+#include "except.hpp"
+
+namespace bandwit {
+namespace tools {
+
+Divider::Divider(uint64_t divisor) : divisor_{divisor} {
+    if (divisor_ == 0) {
+        THROW_MSG(std::runtime_error, "Divider needs a divisor other than 0");
+    }
+
+#ifdef __SIZEOF_INT128__
+    // floor((2^128 - 1) / divisor) + 1, which wraps around to 0 for a
+    // divisor of 1, and divide() takes that to mean the dividend as is
+    reciprocal_ = ~U128{0} / divisor_ + 1;
+#endif
+}
+
+} // namespace tools
+} // namespace bandwit
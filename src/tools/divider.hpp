@@ -0,0 +1,45 @@
+#ifndef DIVIDER_H
+#define DIVIDER_H
+
+#include <cstdint>
+
+namespace bandwit {
+namespace tools {
+
+// Divides by a divisor that is only known at runtime, but never changes once
+// it is, with multiplications instead of a division. The reciprocal is worked
+// out once, as in Lemire et al., "Faster Remainder by Direct Computation".
+// The quotient is exact for any dividend.
+class Divider {
+  public:
+    explicit Divider(uint64_t divisor);
+
+    uint64_t divisor() const { return divisor_; }
+
+    uint64_t divide(uint64_t dividend) const {
+#ifdef __SIZEOF_INT128__
+        if (reciprocal_ == 0) {
+            return dividend;
+        }
+        // the upper 64 bits of the 192 bit product of the reciprocal and
+        // the dividend
+        U128 low = (reciprocal_ & UINT64_MAX) * dividend;
+        U128 high = (reciprocal_ >> 64) * dividend;
+        return static_cast<uint64_t>((high + (low >> 64)) >> 64);
+#else
+        return dividend / divisor_;
+#endif
+    }
+
+  private:
+    uint64_t divisor_;
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 U128;
+    U128 reciprocal_;
+#endif
+};
+
+} // namespace tools
+} // namespace bandwit
+
+#endif // DIVIDER_H
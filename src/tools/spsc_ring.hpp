@@ -0,0 +1,73 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "macros.hpp"
+
+namespace bandwit {
+namespace tools {
+
+// A bounded lock-free queue for exactly one producer thread and one consumer
+// thread. The capacity is rounded up to a power of two so that positions can
+// be mapped to slots with a mask.
+template <typename T> class SpscRing {
+  public:
+    explicit SpscRing(std::size_t capacity)
+        : slots_(round_up(capacity)), mask_{slots_.size() - 1} {}
+
+    CLASS_DISABLE_COPIES(SpscRing)
+    CLASS_DISABLE_MOVES(SpscRing)
+
+    // Called by the producer. Returns false if the ring is full.
+    bool try_push(const T &item) {
+        auto head = head_.load(std::memory_order_relaxed);
+        auto tail = tail_.load(std::memory_order_acquire);
+        if (head - tail == slots_.size()) {
+            return false;
+        }
+
+        slots_[head & mask_] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Called by the consumer. Returns false if the ring is empty.
+    bool try_pop(T &item) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        auto head = head_.load(std::memory_order_acquire);
+        if (head == tail) {
+            return false;
+        }
+
+        item = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return slots_.size(); }
+
+  private:
+    static std::size_t round_up(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    // Written by the producer and the consumer respectively, kept on separate
+    // cache lines so that they don't invalidate each other's line.
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+
+    alignas(64) std::vector<T> slots_;
+    std::size_t mask_;
+};
+
+} // namespace tools
+} // namespace bandwit
+
+#endif // SPSC_RING_H
@@ -0,0 +1,20 @@
+#include "stop_flag.hpp"
+
+namespace bandwit {
+namespace tools {
+
+void StopFlag::request_stop() {
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stop_requested_ = true;
+    }
+    cond_.notify_all();
+}
+
+bool StopFlag::wait_for(std::chrono::nanoseconds duration) {
+    std::unique_lock<std::mutex> lock{mutex_};
+    return cond_.wait_for(lock, duration, [this] { return stop_requested_; });
+}
+
+} // namespace tools
+} // namespace bandwit
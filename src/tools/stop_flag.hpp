@@ -0,0 +1,37 @@
+#ifndef STOP_FLAG_H
+#define STOP_FLAG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "macros.hpp"
+
+namespace bandwit {
+namespace tools {
+
+// Tells a thread that is waiting for some time to pass to stop, without it
+// having to wake up now and then to check.
+class StopFlag {
+  public:
+    StopFlag() = default;
+
+    CLASS_DISABLE_COPIES(StopFlag)
+    CLASS_DISABLE_MOVES(StopFlag)
+
+    void request_stop();
+
+    // Blocks for `duration`, or until a stop is requested. Returns whether a
+    // stop was requested.
+    bool wait_for(std::chrono::nanoseconds duration);
+
+  private:
+    std::mutex mutex_{};
+    std::condition_variable cond_{};
+    bool stop_requested_{false};
+};
+
+} // namespace tools
+} // namespace bandwit
+
+#endif // STOP_FLAG_H
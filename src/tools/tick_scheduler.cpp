@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <stdexcept>
+
+#include "except.hpp"
+#include "macros.hpp"
+#include "tick_scheduler.hpp"
+
+namespace bandwit {
+namespace tools {
+
+Nanos TickStats::jitter_mean() const {
+    if (num_ticks == 0) {
+        return Nanos{0};
+    }
+    return jitter_total / num_ticks;
+}
+
+Tick TickScheduler::start() {
+    start_ = now_monotonic();
+    start_tp_ = Clock::now();
+    index_ = 0;
+
+    return Tick{index_, 0, start_tp_};
+}
+
+std::optional<Tick>
+TickScheduler::wait_for_tick(StopFlag &stop) {
+    auto target = deadline();
+
+    // Wait for the whole interval in one go, a stop request cuts it short.
+    // The wait is measured on a clock of the standard library, which need not
+    // be CLOCK_MONOTONIC, so should it end early we sleep off the rest
+    // against the absolute deadline.
+    if (stop.wait_for(target - now_monotonic())) {
+        return std::nullopt;
+    }
+    if (now_monotonic() < target) {
+        sleep_until(target);
+    }
+
+    // If we were held up for longer than an interval we have missed one or
+    // more ticks. We don't fire them late, we skip ahead to the tick that is
+    // due now.
+    auto lateness = now_monotonic() - target;
+    auto missed = lateness / interval_;
+    Nanos jitter = lateness - missed * interval_;
+
+    index_ += 1 + U64(missed);
+
+    stats_.num_ticks += 1;
+    stats_.num_missed += U64(missed);
+    stats_.jitter_min = std::min(stats_.jitter_min, jitter);
+    stats_.jitter_max = std::max(stats_.jitter_max, jitter);
+    stats_.jitter_total += jitter;
+
+    return Tick{index_, U64(missed), start_tp_ + interval_ * index_};
+}
+
+const TickStats &TickScheduler::get_stats() const { return stats_; }
+
+Nanos TickScheduler::now_monotonic() {
+    struct timespec ts {};
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+        THROW_CERROR(std::runtime_error,
+                     "TickScheduler.now_monotonic failed in clock_gettime()");
+    }
+
+    return std::chrono::seconds{ts.tv_sec} + Nanos{ts.tv_nsec};
+}
+
+void TickScheduler::sleep_until(Nanos target) {
+    struct timespec ts {};
+    ts.tv_sec = target.count() / 1000000000;
+    ts.tv_nsec = target.count() % 1000000000;
+
+    // A signal (eg. SIGWINCH) interrupts the sleep, but since the deadline is
+    // absolute we can just go back to sleep.
+    int rv = 0;
+    do {
+        rv = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+    } while (rv == EINTR);
+
+    if (rv != 0) {
+        errno = rv;
+        THROW_CERROR(std::runtime_error,
+                     "TickScheduler.sleep_until failed in clock_nanosleep()");
+    }
+}
+
+Nanos TickScheduler::deadline() const {
+    return start_ + interval_ * (index_ + 1);
+}
+
+} // namespace tools
+} // namespace bandwit
@@ -0,0 +1,70 @@
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+#include "aliases.hpp"
+#include "stop_flag.hpp"
+
+namespace bandwit {
+namespace tools {
+
+using Nanos = std::chrono::nanoseconds;
+
+struct Tick {
+    // the number of intervals since the scheduler was started
+    uint64_t index;
+    // the number of ticks we were too late for since the previous tick
+    uint64_t missed;
+    // the wall clock time the tick was scheduled for
+    TimePoint tp;
+};
+
+struct TickStats {
+    uint64_t num_ticks{0};
+    uint64_t num_missed{0};
+
+    // how late we woke up relative to the deadline
+    Nanos jitter_min{Nanos::max()};
+    Nanos jitter_max{0};
+    Nanos jitter_total{0};
+
+    Nanos jitter_mean() const;
+};
+
+// Fires ticks on absolute deadlines measured on CLOCK_MONOTONIC, so that
+// time spent between ticks and oversleeping do not add up over time, and
+// wall clock adjustments do not disturb the cadence.
+class TickScheduler {
+  public:
+    explicit TickScheduler(Millis interval) : interval_{interval} {}
+
+    // returns the first tick, which is due immediately
+    Tick start();
+    // Sleeps until the next deadline. Returns nullopt if a stop was requested
+    // in the meantime.
+    std::optional<Tick> wait_for_tick(StopFlag &stop);
+
+    const TickStats &get_stats() const;
+
+  private:
+    static Nanos now_monotonic();
+    static void sleep_until(Nanos target);
+
+    Nanos deadline() const;
+
+    Millis interval_{};
+    uint64_t index_{0};
+
+    Nanos start_{0};
+    TimePoint start_tp_{};
+
+    TickStats stats_{};
+};
+
+} // namespace tools
+} // namespace bandwit
+
+#endif // TICK_SCHEDULER_H
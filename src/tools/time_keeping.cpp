@@ -1,4 +1,5 @@
 #include "time_keeping.hpp"
+#include "macros.hpp"
 
 namespace bandwit {
 namespace tools {
@@ -27,5 +28,10 @@ int TimeKeeping::get_seconds(TimePoint tp) {
     return local_tm.tm_sec;
 }
 
+int TimeKeeping::get_millis(TimePoint tp) {
+    auto since_epoch = MILLIS(tp.time_since_epoch());
+    return INT(since_epoch.count() % 1000);
+}
+
 } // namespace tools
 } // namespace bandwit
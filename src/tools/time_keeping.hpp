@@ -12,6 +12,7 @@ class TimeKeeping {
     int get_hours(TimePoint tp);
     int get_minutes(TimePoint tp);
     int get_seconds(TimePoint tp);
+    int get_millis(TimePoint tp);
 };
 
 } // namespace tools
@@ -0,0 +1,67 @@
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "except.hpp"
+#include "wakeup_pipe.hpp"
+
+namespace bandwit {
+namespace tools {
+
+WakeupPipe::WakeupPipe() {
+    int fds[2];
+    if (pipe(fds) < 0) {
+        THROW_CERROR(std::runtime_error, "WakeupPipe failed in pipe()");
+    }
+    read_fd_ = fds[0];
+    write_fd_ = fds[1];
+
+    // pipe2() would do this in one go, but not everywhere
+    for (auto fd : fds) {
+        if ((fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) < 0) ||
+            (fcntl(fd, F_SETFD, FD_CLOEXEC) < 0)) {
+            close(read_fd_);
+            close(write_fd_);
+            THROW_CERROR(std::runtime_error, "WakeupPipe failed in fcntl()");
+        }
+    }
+}
+
+WakeupPipe::~WakeupPipe() {
+    close(read_fd_);
+    close(write_fd_);
+}
+
+int WakeupPipe::get_fd() const { return read_fd_; }
+
+void WakeupPipe::notify() {
+    // A signal handler must leave errno as it found it. If the pipe is full
+    // there are wakeups pending already, so a failed write loses nothing.
+    int saved_errno = errno;
+    char byte = 1;
+    [[maybe_unused]] auto rv = write(write_fd_, &byte, 1);
+    errno = saved_errno;
+}
+
+bool WakeupPipe::drain() {
+    bool notified = false;
+    char buf[64];
+
+    while (true) {
+        auto rv = read(read_fd_, buf, sizeof(buf));
+        if (rv > 0) {
+            notified = true;
+            continue;
+        }
+        if ((rv < 0) && (errno == EINTR)) {
+            continue;
+        }
+        break;
+    }
+
+    return notified;
+}
+
+} // namespace tools
+} // namespace bandwit
@@ -0,0 +1,37 @@
+#ifndef WAKEUP_PIPE_H
+#define WAKEUP_PIPE_H
+
+#include "macros.hpp"
+
+namespace bandwit {
+namespace tools {
+
+// A pipe that another thread, or a signal handler, writes to in order to wake
+// up a thread that waits for it to become readable, eg. in poll(). Both ends
+// are non-blocking, so notifying never blocks, and a wakeup that is already
+// pending absorbs the ones after it.
+class WakeupPipe {
+  public:
+    WakeupPipe();
+    ~WakeupPipe();
+
+    CLASS_DISABLE_COPIES(WakeupPipe)
+    CLASS_DISABLE_MOVES(WakeupPipe)
+
+    // the end to wait on
+    int get_fd() const;
+
+    // async-signal-safe
+    void notify();
+    // empties the pipe, returns whether there was anything in it
+    bool drain();
+
+  private:
+    int read_fd_{-1};
+    int write_fd_{-1};
+};
+
+} // namespace tools
+} // namespace bandwit
+
+#endif // WAKEUP_PIPE_H
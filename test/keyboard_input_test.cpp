@@ -0,0 +1,101 @@
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "check.hpp"
+#include "termui/keyboard_input.hpp"
+
+using bandwit::termui::KeyboardInputReader;
+using bandwit::termui::KeyPress;
+
+// Stands in for the terminal: whatever is written to it can be read right
+// away, without blocking.
+class ScriptedInput {
+  public:
+    ScriptedInput() {
+        int fds[2];
+        CHECK(pipe(fds) == 0);
+        CHECK(fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0);
+        write_fd_ = fds[1];
+        fl_ = fdopen(fds[0], "r");
+        CHECK(fl_ != nullptr);
+    }
+
+    ~ScriptedInput() {
+        fclose(fl_);
+        close(write_fd_);
+    }
+
+    void type(const std::string &input) {
+        CHECK(write(write_fd_, input.data(), input.size()) ==
+              static_cast<ssize_t>(input.size()));
+    }
+
+    FILE *file() { return fl_; }
+
+  private:
+    int write_fd_{-1};
+    FILE *fl_{nullptr};
+};
+
+static std::vector<KeyPress> pop_all(KeyboardInputReader &reader) {
+    std::vector<KeyPress> keys{};
+    KeyPress key{};
+    while (reader.pop(key)) {
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+int main() {
+    ScriptedInput input{};
+    KeyboardInputReader reader{input.file()};
+
+    // nothing typed yet
+    reader.read_available();
+    CHECK(pop_all(reader).empty());
+
+    // every key of a burst comes out of a single read, in order
+    std::string burst{};
+    std::vector<KeyPress> expected{};
+    for (int i = 0; i < 500; ++i) {
+        burst += "\033[D";
+        expected.push_back(KeyPress::ARROW_LEFT);
+        burst += "s";
+        expected.push_back(KeyPress::LETTER_S);
+        burst += "\033OC";
+        expected.push_back(KeyPress::ARROW_RIGHT);
+    }
+    input.type(burst);
+    reader.read_available();
+    CHECK(pop_all(reader) == expected);
+
+    // an escape sequence split across reads is only a key once it's complete
+    input.type("t\033[1;");
+    reader.read_available();
+    CHECK(pop_all(reader) == std::vector<KeyPress>{KeyPress::LETTER_T});
+    input.type("5Aq");
+    reader.read_available();
+    CHECK(pop_all(reader) ==
+          (std::vector<KeyPress>{KeyPress::ARROW_UP, KeyPress::QUIT}));
+
+    // input read elsewhere, eg. while waiting for a reply from the terminal,
+    // goes before what is read next
+    reader.feed("i\033");
+    input.type("[Bc");
+    reader.read_available();
+    CHECK(pop_all(reader) ==
+          (std::vector<KeyPress>{KeyPress::LETTER_I, KeyPress::ARROW_DOWN,
+                                 KeyPress::LETTER_C}));
+
+    // a sequence cut short by the next one doesn't take the next one along
+    input.type("\033[\033[A\n");
+    reader.read_available();
+    CHECK(pop_all(reader) == (std::vector<KeyPress>{
+                                 KeyPress::ARROW_UP,
+                                 KeyPress::CARRIAGE_RETURN}));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "check.hpp"
+#include "macros.hpp"
+#include "sampling/quantile_sketch.hpp"
+
+using bandwit::sampling::QuantileSketch;
+
+// The sketch answers within 5% of the true value at the rank asked for. We
+// only ask for the quantiles the UI shows, the lowest bins are merged once
+// the samples span a wide range.
+static const double relative_accuracy = 0.05;
+static const std::vector<double> quantiles{0.25, 0.5,  0.75, 0.9,
+                                           0.95, 0.99, 1.0};
+
+static void check_quantiles(const QuantileSketch &sketch,
+                            std::vector<uint64_t> samples) {
+    std::sort(samples.begin(), samples.end());
+
+    CHECK(sketch.count() == samples.size());
+    CHECK(sketch.min() == samples.front());
+    CHECK(sketch.max() == samples.back());
+
+    for (auto q : quantiles) {
+        auto expected = F64(samples[SIZE_T(q * F64(samples.size() - 1))]);
+        auto actual = F64(sketch.quantile(q));
+
+        auto error = expected == 0.0 ? actual
+                                     : std::fabs(actual - expected) / expected;
+        if (error > relative_accuracy + 1e-9) {
+            fprintf(stderr, "q %.2f expected %.0f got %.0f\n", q, expected,
+                    actual);
+        }
+        CHECK(error <= relative_accuracy + 1e-9);
+    }
+}
+
+static void check_distribution(const std::vector<uint64_t> &samples) {
+    QuantileSketch sketch{};
+    for (auto sample : samples) {
+        sketch.add(sample, 1);
+    }
+    check_quantiles(sketch, samples);
+
+    // the same samples spread over sketches that are merged, as they are
+    // when buckets are rolled up
+    QuantileSketch merged{};
+    QuantileSketch part{};
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        part.add(samples[i], 1);
+        if ((i % 60 == 59) || (i + 1 == samples.size())) {
+            merged.merge(part);
+            part.clear();
+        }
+    }
+    check_quantiles(merged, samples);
+}
+
+int main() {
+    std::mt19937_64 rng{42};
+    const std::size_t num_samples = 100000;
+
+    std::vector<uint64_t> uniform{};
+    std::uniform_int_distribution<uint64_t> uniform_dist{1000, 100000};
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        uniform.push_back(uniform_dist(rng));
+    }
+    check_distribution(uniform);
+
+    // bursty traffic: mostly a low rate, with a long tail
+    std::vector<uint64_t> lognormal{};
+    std::lognormal_distribution<double> lognormal_dist{10.0, 1.0};
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        lognormal.push_back(U64(std::llround(lognormal_dist(rng))) + 1);
+    }
+    check_distribution(lognormal);
+
+    // an idle link, with the odd packet
+    std::vector<uint64_t> idle{};
+    std::exponential_distribution<double> exponential_dist{1.0 / 1500.0};
+    for (std::size_t i = 0; i < num_samples; ++i) {
+        idle.push_back(i % 5 == 0 ? U64(std::llround(exponential_dist(rng)))
+                                  : 0);
+    }
+    check_distribution(idle);
+
+    std::vector<uint64_t> constant(num_samples, 125000000);
+    check_distribution(constant);
+
+    // the bins are bounded, however wide the range of the samples
+    QuantileSketch wide{};
+    for (uint64_t value = 1; value != 0; value <<= 1) {
+        wide.add(value, 1);
+    }
+    CHECK(wide.memory_usage() <= QuantileSketch::max_memory_usage());
+
+    return EXIT_SUCCESS;
+}